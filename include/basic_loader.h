@@ -0,0 +1,42 @@
+#ifndef BASIC_LOADER_H
+#define BASIC_LOADER_H
+
+#include "emulator.h"
+
+// Loads Integer BASIC source straight into BASIC's program area. The lines
+// go through BASIC's own line entry, run headless and flat out, so the
+// tokenized program and the zero-page pointers are exactly what typing the
+// lines in would give, without the echo, the display or the 1 MHz clock.
+
+#define BASIC_LOMEM 0x4A // Zero-page pointers of Apple-1 Integer BASIC
+#define BASIC_HIMEM 0x4C
+#define BASIC_PP 0xCA    // Start of the program, which ends at HIMEM
+#define BASIC_PV 0xCC    // End of the variables, which start at LOMEM
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        uint32_t lines;        // Lines of source entered
+        uint32_t errors;       // Lines BASIC rejected
+        char first_error[24];  // BASIC's message for the first of them
+        uint32_t cycles;       // 6502 cycles it took
+        uint16_t program_start; // PP..HIMEM afterwards
+        uint16_t program_end;
+    } basic_load_result_t;
+
+    // Enter `len` bytes of source as if typed at BASIC's prompt, after
+    // cold-starting BASIC (which also clears any program) if `new_program`
+    // is set. The 6502 is left at BASIC's prompt. A line may be split across
+    // calls. Returns 0 if BASIC stopped taking input. Call from the CPU side.
+    int basic_load(apple1_t *m, const char *text, uint32_t len, int new_program,
+                   basic_load_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BASIC_LOADER_H
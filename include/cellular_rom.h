@@ -1,60 +0,0 @@
-#ifndef CELLULAR_ROM_H
-#define CELLULAR_ROM_H
-
-// Cellular Automaton program for Apple-1
-// Load at address $0300 (768 decimal)
-// Run with: 300R
-
-const unsigned char cellular_rom[] = {
-  0x20, 0xf1, 0x03, 0x20, 0x1b, 0x05, 0x20, 0x57, 0x03, 0x20, 0xad, 0x03,
-  0xa9, 0x00, 0x85, 0x1c, 0xa0, 0x29, 0xa5, 0x1e, 0xf0, 0x01, 0xc8, 0xa5,
-  0x14, 0x4a, 0x08, 0x4a, 0x26, 0x1c, 0x28, 0x26, 0x1c, 0xa5, 0x10, 0x2a,
-  0x20, 0x6f, 0x03, 0x26, 0x1c, 0x8a, 0x48, 0x98, 0x48, 0x20, 0x7a, 0x03,
-  0x68, 0xa8, 0x68, 0xaa, 0x26, 0x19, 0x26, 0x18, 0x26, 0x17, 0x26, 0x16,
-  0x26, 0x15, 0x88, 0xd0, 0xe3, 0xad, 0x11, 0xd0, 0x10, 0xc0, 0xad, 0x10,
-  0xd0, 0x29, 0x7f, 0x20, 0x20, 0x05, 0xc9, 0x4d, 0xf0, 0xae, 0xc9, 0x1b,
-  0xd0, 0xb0, 0x60, 0x20, 0xad, 0x03, 0xa0, 0x28, 0x20, 0x6f, 0x03, 0xb0,
-  0x05, 0x20, 0x16, 0x05, 0x90, 0x05, 0xa9, 0x2a, 0x20, 0xef, 0xff, 0x88,
-  0xd0, 0xee, 0x60, 0x26, 0x14, 0x26, 0x13, 0x26, 0x12, 0x26, 0x11, 0x26,
-  0x10, 0x60, 0xa5, 0x1c, 0xa4, 0x1e, 0xf0, 0x15, 0x29, 0x1f, 0xa2, 0x00,
-  0xa0, 0x05, 0x4a, 0x90, 0x01, 0xe8, 0x88, 0xd0, 0xf9, 0xa0, 0x01, 0x84,
-  0x1b, 0x8a, 0x38, 0xb0, 0x07, 0x29, 0x07, 0xa2, 0x01, 0x86, 0x1b, 0xaa,
-  0xf0, 0x05, 0x06, 0x1b, 0xca, 0xd0, 0xfb, 0xa5, 0x1a, 0x25, 0x1b, 0xd0,
-  0x02, 0x18, 0x60, 0x38, 0x60, 0xa2, 0x05, 0xb5, 0x14, 0x95, 0x0f, 0xca,
-  0xd0, 0xf9, 0x60, 0x20, 0x3f, 0x45, 0x4c, 0x55, 0x52, 0x20, 0x3f, 0x53,
-  0x55, 0x49, 0x44, 0x41, 0x52, 0x49, 0x4e, 0x49, 0x54, 0x49, 0x41, 0x4c,
-  0x20, 0x53, 0x54, 0x41, 0x54, 0x45, 0x3a, 0x00, 0x31, 0x2e, 0x20, 0x44,
-  0x4f, 0x54, 0x00, 0x32, 0x2e, 0x20, 0x52, 0x41, 0x4e, 0x44, 0x4f, 0x4d,
-  0x00, 0x33, 0x2e, 0x20, 0x45, 0x4e, 0x54, 0x45, 0x52, 0x00, 0x3e, 0x20,
-  0xff, 0x20, 0x3c, 0x04, 0x20, 0x20, 0x05, 0x20, 0xef, 0xff, 0xc9, 0x1b,
-  0xf0, 0x3b, 0x38, 0xe9, 0x30, 0xc9, 0x04, 0xb0, 0x31, 0xaa, 0xf0, 0x2e,
-  0x20, 0x1b, 0x05, 0xca, 0xd0, 0x10, 0xa9, 0x00, 0x85, 0x15, 0x85, 0x16,
-  0x85, 0x18, 0x85, 0x19, 0xa9, 0x10, 0x85, 0x17, 0xd0, 0x55, 0xca, 0xd0,
-  0x12, 0xa2, 0x05, 0x20, 0xdb, 0x04, 0x95, 0x14, 0x20, 0xdb, 0x04, 0x20,
-  0xdb, 0x04, 0xca, 0xd0, 0xf2, 0xf0, 0x40, 0x4c, 0x58, 0x04, 0x4c, 0x00,
-  0x03, 0x68, 0x68, 0x60, 0x20, 0x1b, 0x05, 0xa2, 0xff, 0xe8, 0xbd, 0xc5,
-  0x03, 0xd0, 0x06, 0x20, 0x1b, 0x05, 0x4c, 0x41, 0x04, 0xc9, 0xff, 0xf0,
-  0x06, 0x20, 0xef, 0xff, 0x4c, 0x41, 0x04, 0x60, 0xa9, 0x3f, 0x20, 0xef,
-  0xff, 0x20, 0x16, 0x05, 0xa0, 0x00, 0x20, 0xa9, 0x04, 0x99, 0x15, 0x00,
-  0x20, 0x16, 0x05, 0xc8, 0xc0, 0x05, 0xd0, 0xf2, 0x20, 0x1b, 0x05, 0xa2,
-  0x08, 0xbd, 0xbc, 0x03, 0x20, 0xef, 0xff, 0xca, 0xd0, 0xf7, 0x20, 0x20,
-  0x05, 0x20, 0xef, 0xff, 0xc9, 0x1b, 0xf0, 0xb1, 0xc9, 0x31, 0xf0, 0x04,
-  0xc9, 0x32, 0xd0, 0xe0, 0x38, 0xe9, 0x31, 0x85, 0x1e, 0x20, 0x1b, 0x05,
-  0xa2, 0x06, 0xbd, 0xb6, 0x03, 0x20, 0xef, 0xff, 0xca, 0xd0, 0xf7, 0x20,
-  0xa9, 0x04, 0x85, 0x1a, 0x60, 0xa2, 0x00, 0x20, 0xcd, 0x04, 0x85, 0x11,
-  0x20, 0x04, 0x05, 0xc9, 0xff, 0xf0, 0xf4, 0x20, 0xe5, 0xff, 0x20, 0xcd,
-  0x04, 0x85, 0x12, 0x20, 0x04, 0x05, 0xc9, 0xff, 0xf0, 0xf4, 0x20, 0xe5,
-  0xff, 0x20, 0xe5, 0x04, 0x60, 0x20, 0x20, 0x05, 0xc9, 0x1b, 0xd0, 0x06,
-  0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x60, 0xa5, 0x1d, 0x0a, 0x90, 0x02,
-  0x49, 0xcf, 0x85, 0x1d, 0x60, 0x20, 0x02, 0x05, 0xc9, 0xff, 0xf0, 0x27,
-  0x48, 0x20, 0x01, 0x05, 0xca, 0xc9, 0xff, 0xd0, 0x02, 0x68, 0x60, 0x85,
-  0x10, 0x68, 0x0a, 0x0a, 0x0a, 0x0a, 0x65, 0x10, 0x60, 0xe8, 0xb5, 0x11,
-  0x49, 0x30, 0xc9, 0x0a, 0x90, 0x08, 0x69, 0x88, 0xc9, 0xfa, 0x90, 0x03,
-  0x29, 0x0f, 0x60, 0xa9, 0xff, 0x60, 0xa9, 0x20, 0x4c, 0xef, 0xff, 0xa9,
-  0x0d, 0x4c, 0xef, 0xff, 0xe6, 0x1d, 0xad, 0x11, 0xd0, 0x10, 0xf9, 0xad,
-  0x10, 0xd0, 0x29, 0x7f, 0x60
-};
-
-const unsigned int cellular_rom_len = 557;
-
-#endif // CELLULAR_ROM_H
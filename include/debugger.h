@@ -0,0 +1,44 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include "emulator.h"
+
+// Debugger, built in with -DFAKE6502_DEBUG: breakpoints, read and write
+// watchpoints on address ranges, single-stepping and register, memory and
+// disassembly listings, driven by command lines typed on the serial port.
+// It works on one machine at a time, the last one broken into or stopped
+// at a breakpoint; the watches move over to it. Without the flag none of it
+// is compiled and run6502() and the bus callbacks carry no checks.
+
+#ifndef MAX_WATCHES
+#define MAX_WATCHES 8
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Stop m's 6502 and take commands (Ctrl+D). Call with the CPU side held.
+    void debugger_break(apple1_t *m);
+
+    // `m` is stopped: run_emulator() runs nothing, typed keys go to
+    // debugger_key() instead of the keyboard
+    int debugger_halted(const apple1_t *m);
+
+    // A key typed while halted. A whole line is run on CR; call with the
+    // CPU side held then.
+    void debugger_key(char c);
+
+    // From the bus callbacks for an access to a watched page
+    void debugger_access(apple1_t *m, uint16_t address, uint8_t value, int write);
+
+    // From run_emulator() after each batch: if it ended on a breakpoint or
+    // watchpoint, report it, halt and return 1
+    int debugger_stopped(apple1_t *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEBUGGER_H
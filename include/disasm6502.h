@@ -0,0 +1,30 @@
+#ifndef DISASM6502_H
+#define DISASM6502_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Names and addressing modes of the 6502 opcodes, as fake6502 implements
+// them (the undocumented ones included)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // The three-letter mnemonic of `opcode`, NUL-terminated into `name`
+    void mnemonic6502(uint8_t opcode, char name[4]);
+
+    // Bytes taken by the instruction starting with `opcode`: 1 to 3
+    int length6502(uint8_t opcode);
+
+    // Disassemble the instruction at `pc` whose bytes are `bytes` (as many
+    // as length6502() says) into `out`, like "LDA ($24),Y" or "BNE $FF29".
+    // Returns its length.
+    int disasm6502(uint16_t pc, const uint8_t *bytes, char *out, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISASM6502_H
@@ -1,9 +1,29 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <stdint.h>
+
 #define DISPLAY_COLS 40
 #define DISPLAY_ROWS 17
 
+// Terminals the display keeps text for; one is shown on the panel at a time
+#ifndef DISPLAY_TERMINALS
+#ifdef DUAL_MACHINE
+#define DISPLAY_TERMINALS 2
+#else
+#define DISPLAY_TERMINALS 1
+#endif
+#endif
+
+// Frames per second display_update() renders at, at most
+#ifndef DISPLAY_FPS
+#define DISPLAY_FPS 50
+#endif
+
+// Bytes of display_get_state(): the text row by row from the top, then the
+// cursor's row and column
+#define DISPLAY_STATE_SIZE (DISPLAY_ROWS * DISPLAY_COLS + 2)
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -13,9 +33,19 @@ extern "C"
     void display_init();
 
     // Write a single character to the display
-    // Handles newlines, wrapping, and scrolling automatically
+    // Handles newlines, wrapping, and scrolling automatically. Only the text
+    // model changes; the panel catches up on the next frame.
     void display_write_char(char c);
 
+    // The same for one terminal, shown or not. Only the shown terminal's
+    // output is echoed to serial.
+    void display_terminal_write_char(int terminal, char c);
+
+    // Put a terminal on the panel; the next frame redraws it. The calls
+    // without a terminal act on the one shown.
+    void display_show(int terminal);
+    int display_shown();
+
     // Write a string to the display
     void display_write(const char *str);
 
@@ -25,9 +55,24 @@ extern "C"
     // Clear the display and reset cursor position
     void display_clear();
 
-    // Update the blinking cursor (call from main loop)
+    // Update the blinking cursor
     void display_update_cursor();
 
+    // Push text changed since the last call to the panel now
+    void display_flush();
+
+    // Blink the cursor and render a frame if one is due (call from main loop)
+    void display_update();
+
+    // Save or restore the text and cursor, for snapshots. A restored screen
+    // is redrawn on the next frame.
+    void display_get_state(uint8_t *state);
+    void display_set_state(const uint8_t *state);
+
+    // Time the glyph atlas renderer against per-glyph drawChar() and print
+    // characters per second for each over serial. Clears the screen.
+    void display_benchmark();
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,15 +8,103 @@ extern "C"
 {
 #endif
 
-    void setup_emulator();
-    void reset_emulator();
-    void step_emulator();
-    void emulator_queue_key(char c);
-    uint8_t read_memory(uint16_t address);
-    void write_memory(uint16_t address, uint8_t value);
+    // One Apple-1: its 6502, RAM, keyboard and display queues. Machines
+    // share nothing but the ROMs, so each can run on its own thread or core;
+    // the calls below are for the thread running it unless they say
+    // otherwise.
+    typedef struct apple1 apple1_t;
+
+    // A machine that has not been set up yet; the first reset_emulator()
+    // does that. NULL if there is no memory for it.
+    apple1_t *emulator_create();
+    void emulator_destroy(apple1_t *m);
+
+    // Its 6502, for the registers and breakpoints
+    cpu6502_t *emulator_cpu(apple1_t *m);
+
+    void setup_emulator(apple1_t *m);
+
+    // The first call sets everything up; after that only the RAM pages
+    // written since are cleared and the boot programs reloaded if need be.
+    // Drops queued keys; call with the CPU side held.
+    void reset_emulator(apple1_t *m);
+
+    // Cycles the 6502 ran from the last reset to Wozmon's "\" prompt, or 0
+    // until it gets there
+    uint32_t emulator_cycles_to_prompt(apple1_t *m);
+
+    // RAM pages written since the last reset
+    uint32_t emulator_dirty_pages(apple1_t *m);
+    void step_emulator(apple1_t *m);
+    uint32_t run_emulator(apple1_t *m, uint32_t cycles);
+    int emulator_waiting_for_key(apple1_t *m);
+    // A key is queued or latched in KBD, so a key-wait loop would end
+    int emulator_key_pending(apple1_t *m);
+    int emulator_output_full(apple1_t *m);
+    typedef struct
+    {
+        uint32_t queued;     // Keys waiting for the 6502 right now
+        uint32_t capacity;   // Size of the key queue
+        uint32_t high_water; // Most keys ever waiting at once
+        uint32_t overflows;  // Keys dropped because the queue was full
+    } key_queue_stats_t;
+
+    // Queue a typed key. Returns 0 (and drops it) if the queue is full.
+    // The key queue is filled from one other thread, the serial side.
+    int emulator_queue_key(apple1_t *m, char c);
+    uint32_t emulator_key_queue_free(apple1_t *m);
+    void emulator_get_key_stats(apple1_t *m, key_queue_stats_t *stats);
+
+    // Keyboard latch and the last key queued, for snapshots
+    typedef struct
+    {
+        uint8_t kbd_data;
+        uint8_t kbd_strobe;
+        char last_char;
+    } keyboard_state_t;
+
+    void emulator_get_keyboard(apple1_t *m, keyboard_state_t *state);
+
+    // Also drops queued keys and output. Call with the CPU side held.
+    void emulator_set_keyboard(apple1_t *m, const keyboard_state_t *state);
+
+    // Next character the 6502 wrote to DSP, for the display side. Returns 0
+    // when there is none.
+    int emulator_read_output(apple1_t *m, char *c);
+    void emulator_print_memory_report();
+    uint8_t read_memory(apple1_t *m, uint16_t address);
+    void write_memory(apple1_t *m, uint16_t address, uint8_t value);
+
+    // RAM runs from $0000 to emulator_ram_size() - 1
+    uint32_t emulator_ram_size();
+
+    // Copy a program into RAM, bypassing the bus. Returns 0, copying
+    // nothing, if any of it falls outside RAM.
+    int emulator_load(apple1_t *m, uint16_t address, const uint8_t *data, uint32_t len);
+
+    // Continue the 6502 at `address` (call between run_emulator() slices)
+    void emulator_run_from(apple1_t *m, uint16_t address);
+
+#ifdef FAKE6502_DEBUG
+#define WATCH_READ 0x01
+#define WATCH_WRITE 0x02
+
+    // Send the 6502's reads and/or writes of a page through the bus
+    // callbacks, which pass them to debugger_access(). 0 maps it back.
+    void emulator_watch_page(apple1_t *m, uint8_t page, uint8_t flags);
+#endif
+
+    // Run the 6502 flat out with `text` as its keyboard and its display
+    // output passed to `output` (with `context`) instead of the display,
+    // until it has read all of the text and waits for another key, or after
+    // max_cycles. Returns the cycles run. Keys already queued are left for
+    // later.
+    uint32_t emulator_type_headless(apple1_t *m, const char *text, uint32_t len,
+                                    void (*output)(void *context, char c), void *context,
+                                    uint32_t max_cycles);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif // EMULATOR_H
\ No newline at end of file
+#endif // EMULATOR_H
@@ -1,16 +1,119 @@
 #pragma once
 #include <stdio.h>
+#include <stdbool.h>
 #include <stdint.h>
 
-extern uint16_t PC;
-extern uint8_t SP, A, X, Y, status;
-void setP(uint8_t x);
-uint8_t getP(void);
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-extern uint8_t read6502(uint16_t address);
-extern void write6502(uint16_t address, uint8_t value);
+#define MAX_TRAPS6502 8
+#define CACHE_LINE6502 64
 
-int nmi6502(void);
-int reset6502(void);
-int irq6502(void);
-int step6502(void);
+#ifdef __cplusplus
+#define ALIGN6502(n) alignas(n)
+#else
+#define ALIGN6502(n) _Alignas(n)
+#endif
+
+typedef struct cpu6502 cpu6502_t;
+
+// Bus callbacks for the pages the page map leaves NULL, passed the context
+// the CPU was set up with
+typedef uint8_t (*read6502_t)(void *context, uint16_t address);
+typedef void (*write6502_t)(void *context, uint16_t address, uint8_t value);
+
+// High-level emulation traps, checked by step6502() and run6502() before
+// each opcode fetch (the bare engines below don't). A handler runs in place
+// of the code at its PC, with the CPU state in `cpu`, and returns the cycles
+// that code would have taken, or 0 to have it interpreted after all.
+typedef uint32_t (*trap6502_t)(cpu6502_t *cpu);
+
+// One 6502 and everything it needs; instances share nothing, so each can
+// run on its own thread. The struct is cache-line aligned, and the registers
+// and the fields every instruction touches come first and fill that one
+// line, so they are not shared with another instance's either. Allocate it
+// (or a struct holding it) with an aligned allocator.
+struct cpu6502 {
+    ALIGN6502(CACHE_LINE6502) uint16_t pc;
+    uint8_t sp, a, x, y;
+    bool c, z, i, d, v, n;  // Flags; see getP()/setP()
+    bool stop;              // stop6502() was called during this batch
+    bool at_breakpoint;     // -DFAKE6502_DEBUG: run6502() stopped at one
+    uint32_t instructions;  // Run by the last run6502()
+    read6502_t read;
+    write6502_t write;
+    void *context;
+
+    // Working state of the table core
+    uint16_t ea;
+    uint8_t opcode, penaltyop, penaltyaddr;
+    uint32_t clockticks;
+
+    // Page map set up by the bus implementation. A non-NULL entry points at
+    // the 256 bytes backing that page and is read or written in place; NULL
+    // pages (I/O) go through the read/write callbacks.
+    const uint8_t *read_pages[256];
+    uint8_t *write_pages[256];
+
+    uint8_t trap_pages[256]; // Traps on each page; 0 skips the lookup
+    uint8_t num_traps;
+    struct { uint16_t pc; trap6502_t handler; } traps[MAX_TRAPS6502];
+
+#ifdef FAKE6502_DEBUG
+    uint8_t bp_pages[256];       // Breakpoints on each page
+    uint8_t bp_bits[65536 / 8];
+#endif
+};
+
+// Clear the CPU, with every page going through the callbacks
+void init6502(cpu6502_t *cpu, read6502_t read, write6502_t write, void *context);
+
+void setP(cpu6502_t *cpu, uint8_t x);
+uint8_t getP(const cpu6502_t *cpu);
+
+int nmi6502(cpu6502_t *cpu);
+int reset6502(cpu6502_t *cpu);
+int irq6502(cpu6502_t *cpu);
+int step6502(cpu6502_t *cpu);
+
+// The two dispatch engines behind step6502(): the original addrtable/optable
+// function-pointer core and the fused single-switch core. step6502() uses the
+// fused one unless built with -DFAKE6502_TABLE_DISPATCH.
+int step6502_tables(cpu6502_t *cpu);
+int step6502_fused(cpu6502_t *cpu);
+
+// Run instructions until at least `cycles` cycles have elapsed, or until a
+// bus callback calls stop6502() during an instruction. Returns the cycles
+// actually executed; cpu->instructions holds the instruction count. The
+// registers are kept in locals for the batch, so the ones in `cpu` are only
+// up to date again once run6502() returns (or a trap handler is called).
+uint32_t run6502(cpu6502_t *cpu, uint32_t cycles);
+void stop6502(cpu6502_t *cpu);
+
+// Passing a NULL handler removes the trap; returns 0 if the table is full
+int trap6502(cpu6502_t *cpu, uint16_t pc, trap6502_t handler);
+
+// Built with -DFAKE6502_PROFILE, step6502() and run6502() report each
+// instruction (or trap) they run: its PC and the cycles it took
+#ifdef FAKE6502_PROFILE
+extern void profile6502(const cpu6502_t *cpu, uint16_t pc, uint32_t ticks);
+#endif
+
+// Built with -DFAKE6502_TRACE, they also report the registers each one left
+#ifdef FAKE6502_TRACE
+extern void trace6502(const cpu6502_t *cpu, uint16_t pc, uint8_t a, uint8_t x, uint8_t y,
+                      uint8_t sp, uint8_t p, uint32_t ticks);
+#endif
+
+// Built with -DFAKE6502_DEBUG, run6502() also stops before an instruction at
+// a breakpoint, with at_breakpoint set (step6502() runs it regardless).
+// breakpoint6502() returns 0 if there was nothing to change.
+#ifdef FAKE6502_DEBUG
+int breakpoint6502(cpu6502_t *cpu, uint16_t pc, int set);
+int is_breakpoint6502(const cpu6502_t *cpu, uint16_t pc);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
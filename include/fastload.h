@@ -0,0 +1,56 @@
+#ifndef FASTLOAD_H
+#define FASTLOAD_H
+
+#include "emulator.h"
+
+// Binary fast-load over the serial port. A frame is
+//
+//   SOH 'L' flags addr(2) len(2) entry(2) crc32(4) data(len)
+//
+// with 16-bit fields little-endian and the CRC-32 (as zlib's crc32()) over
+// the data. It is loaded straight into RAM, and with FASTLOAD_RUN set the
+// 6502 continues at entry. With FASTLOAD_BASIC the data is Integer BASIC
+// source instead, entered into BASIC's program by basic_load(); addr and
+// entry are unused. The device answers each frame with a report line and
+// ACK, or NAK if it was rejected. tools/upload.py is the sender.
+
+#define FASTLOAD_SOH 0x01        // Ctrl+A starts a frame
+#define FASTLOAD_MAGIC 'L'
+#define FASTLOAD_ACK 0x06
+#define FASTLOAD_NAK 0x15
+#define FASTLOAD_RUN 0x01        // flags: set PC to entry once loaded
+#define FASTLOAD_BASIC 0x02      // flags: data is BASIC source
+#define FASTLOAD_NEW 0x04        // flags: cold-start BASIC before the source
+#define FASTLOAD_MAX_BLOCK 1024  // Largest len accepted
+#define FASTLOAD_TIMEOUT_MS 1000 // Drop a frame that stalls this long
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum
+    {
+        FASTLOAD_IDLE,  // Not part of a frame; pass the byte on as a key
+        FASTLOAD_BUSY,  // Taken as part of a frame
+        FASTLOAD_BLOCK, // Frame complete and its CRC good; see fastload_apply()
+        FASTLOAD_ERROR, // Frame rejected: bad length or CRC
+    } fastload_status_t;
+
+    // Feed one byte received from the serial port
+    fastload_status_t fastload_feed(uint8_t byte, uint32_t now_ms);
+
+    // Write the last complete block to m's RAM, or enter it into its BASIC,
+    // and if asked point its 6502 at the entry. Call from the CPU side. Leaves a
+    // report line in `report` and returns the reply for the sender:
+    // FASTLOAD_ACK, or FASTLOAD_NAK if the block doesn't fit in RAM or BASIC
+    // stopped taking input.
+    uint8_t fastload_apply(apple1_t *m, char *report, uint32_t size);
+
+    uint32_t fastload_crc32(const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FASTLOAD_H
@@ -0,0 +1,62 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "emulator.h"
+
+// Software library: Apple-1 programs packed into one compressed blob in
+// flash by tools/mklibrary.py (from programs/library.txt), and unpacked
+// straight into RAM on request. Each segment is its own LZ4 block, so
+// nothing but the program itself ever lands in DRAM.
+
+#define LIBRARY_BOOT 0x01 // flags: loaded by setup_emulator(), not run
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        uint16_t address;
+        uint16_t len;
+        uint32_t offset; // Of its LZ4 block in library_blob
+        uint32_t packed; // Size of that block
+    } library_segment_t;
+
+    typedef struct
+    {
+        const char *name;  // Short name, for load-by-name
+        const char *title; // For the menu
+        uint16_t entry;
+        uint8_t flags;
+        uint8_t segments;       // How many, in library_segments
+        uint16_t first_segment; // Index of the first
+    } library_entry_t;
+
+    uint32_t library_count();
+    const library_entry_t *library_entry(uint32_t index);
+
+    // Index of the entry called `name`, or -1
+    int library_find(const char *name);
+
+    // Unpack an entry's segments into RAM. Returns the bytes loaded, or -1 if
+    // a segment falls outside RAM (nothing is loaded) or doesn't unpack to
+    // its length. Call from the CPU side; the caller starts it at its entry.
+    int32_t library_load(apple1_t *m, uint32_t index);
+
+    // Load the LIBRARY_BOOT entries, saying so if `verbose`; setup_emulator()
+    // calls this
+    void library_load_boot(apple1_t *m, int verbose);
+
+    // Fill `image` (emulator_ram_size() bytes) with RAM as setup_emulator()
+    // leaves it: zero but for the LIBRARY_BOOT entries
+    void library_boot_image(uint8_t *image);
+
+    // Flash taken by the blob and its index
+    uint32_t library_flash_size();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBRARY_H
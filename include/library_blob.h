@@ -0,0 +1,141 @@
+#ifndef LIBRARY_BLOB_H
+#define LIBRARY_BLOB_H
+
+// Generated by tools/mklibrary.py from programs/library.txt; don't edit
+// 5 programs, 1586 bytes packed into 1333
+
+#include "library.h"
+
+static const uint8_t library_blob[] = {
+  0xf0, 0xff, 0x62, 0x20, 0xf1, 0x03, 0x20, 0x1b, 0x05, 0x20, 0x57, 0x03,
+  0x20, 0xad, 0x03, 0xa9, 0x00, 0x85, 0x1c, 0xa0, 0x29, 0xa5, 0x1e, 0xf0,
+  0x01, 0xc8, 0xa5, 0x14, 0x4a, 0x08, 0x4a, 0x26, 0x1c, 0x28, 0x26, 0x1c,
+  0xa5, 0x10, 0x2a, 0x20, 0x6f, 0x03, 0x26, 0x1c, 0x8a, 0x48, 0x98, 0x48,
+  0x20, 0x7a, 0x03, 0x68, 0xa8, 0x68, 0xaa, 0x26, 0x19, 0x26, 0x18, 0x26,
+  0x17, 0x26, 0x16, 0x26, 0x15, 0x88, 0xd0, 0xe3, 0xad, 0x11, 0xd0, 0x10,
+  0xc0, 0xad, 0x10, 0xd0, 0x29, 0x7f, 0x20, 0x20, 0x05, 0xc9, 0x4d, 0xf0,
+  0xae, 0xc9, 0x1b, 0xd0, 0xb0, 0x60, 0x20, 0xad, 0x03, 0xa0, 0x28, 0x20,
+  0x6f, 0x03, 0xb0, 0x05, 0x20, 0x16, 0x05, 0x90, 0x05, 0xa9, 0x2a, 0x20,
+  0xef, 0xff, 0x88, 0xd0, 0xee, 0x60, 0x26, 0x14, 0x26, 0x13, 0x26, 0x12,
+  0x26, 0x11, 0x26, 0x10, 0x60, 0xa5, 0x1c, 0xa4, 0x1e, 0xf0, 0x15, 0x29,
+  0x1f, 0xa2, 0x00, 0xa0, 0x05, 0x4a, 0x90, 0x01, 0xe8, 0x88, 0xd0, 0xf9,
+  0xa0, 0x01, 0x84, 0x1b, 0x8a, 0x38, 0xb0, 0x07, 0x29, 0x07, 0xa2, 0x01,
+  0x86, 0x1b, 0xaa, 0xf0, 0x05, 0x06, 0x1b, 0xca, 0xd0, 0xfb, 0xa5, 0x1a,
+  0x25, 0x1b, 0xd0, 0x02, 0x18, 0x60, 0x38, 0x60, 0xa2, 0x05, 0xb5, 0x14,
+  0x95, 0x0f, 0xca, 0xd0, 0xf9, 0x60, 0x20, 0x3f, 0x45, 0x4c, 0x55, 0x52,
+  0x20, 0x3f, 0x53, 0x55, 0x49, 0x44, 0x41, 0x52, 0x49, 0x4e, 0x49, 0x54,
+  0x49, 0x41, 0x4c, 0x20, 0x53, 0x54, 0x41, 0x54, 0x45, 0x3a, 0x00, 0x31,
+  0x2e, 0x20, 0x44, 0x4f, 0x54, 0x00, 0x32, 0x2e, 0x20, 0x52, 0x41, 0x4e,
+  0x44, 0x4f, 0x4d, 0x00, 0x33, 0x2e, 0x20, 0x45, 0x4e, 0x54, 0x45, 0x52,
+  0x00, 0x3e, 0x20, 0xff, 0x20, 0x3c, 0x04, 0x20, 0x20, 0x05, 0x20, 0xef,
+  0xff, 0xc9, 0x1b, 0xf0, 0x3b, 0x38, 0xe9, 0x30, 0xc9, 0x04, 0xb0, 0x31,
+  0xaa, 0xf0, 0x2e, 0x20, 0x1b, 0x05, 0xca, 0xd0, 0x10, 0xa9, 0x00, 0x85,
+  0x15, 0x85, 0x16, 0x85, 0x18, 0x85, 0x19, 0xa9, 0x10, 0x85, 0x17, 0xd0,
+  0x55, 0xca, 0xd0, 0x12, 0xa2, 0x05, 0x20, 0xdb, 0x04, 0x95, 0x14, 0x20,
+  0xdb, 0x04, 0x20, 0xdb, 0x04, 0xca, 0xd0, 0xf2, 0xf0, 0x40, 0x4c, 0x58,
+  0x04, 0x4c, 0x00, 0x03, 0x68, 0x68, 0x60, 0x20, 0x1b, 0x05, 0xa2, 0xff,
+  0xe8, 0xbd, 0xc5, 0x03, 0xd0, 0x06, 0x20, 0x1b, 0x05, 0x4c, 0x41, 0x04,
+  0xc9, 0xff, 0xf0, 0x06, 0x20, 0xef, 0xff, 0x4c, 0x41, 0x04, 0x60, 0xa9,
+  0x3f, 0x20, 0xef, 0xff, 0x20, 0x16, 0x05, 0xa0, 0x00, 0x20, 0xa9, 0x04,
+  0x99, 0x15, 0x00, 0x20, 0x16, 0x05, 0xc8, 0xc0, 0x05, 0xd0, 0xf2, 0x34,
+  0x00, 0xa5, 0x08, 0xbd, 0xbc, 0x03, 0x20, 0xef, 0xff, 0xca, 0xd0, 0xf7,
+  0x8a, 0x00, 0xe0, 0xb1, 0xc9, 0x31, 0xf0, 0x04, 0xc9, 0x32, 0xd0, 0xe0,
+  0x38, 0xe9, 0x31, 0x85, 0x1e, 0x25, 0x00, 0x34, 0x06, 0xbd, 0xb6, 0x25,
+  0x00, 0xf0, 0x07, 0xa9, 0x04, 0x85, 0x1a, 0x60, 0xa2, 0x00, 0x20, 0xcd,
+  0x04, 0x85, 0x11, 0x20, 0x04, 0x05, 0xc9, 0xff, 0xf0, 0xf4, 0x20, 0xe5,
+  0xff, 0x0f, 0x00, 0x17, 0x12, 0x0f, 0x00, 0x30, 0xe5, 0x04, 0x60, 0x82,
+  0x01, 0x41, 0x1b, 0xd0, 0x06, 0x68, 0x01, 0x00, 0xd0, 0x60, 0xa5, 0x1d,
+  0x0a, 0x90, 0x02, 0x49, 0xcf, 0x85, 0x1d, 0x60, 0x20, 0x02, 0x26, 0x00,
+  0xf0, 0x33, 0x27, 0x48, 0x20, 0x01, 0x05, 0xca, 0xc9, 0xff, 0xd0, 0x02,
+  0x68, 0x60, 0x85, 0x10, 0x68, 0x0a, 0x0a, 0x0a, 0x0a, 0x65, 0x10, 0x60,
+  0xe8, 0xb5, 0x11, 0x49, 0x30, 0xc9, 0x0a, 0x90, 0x08, 0x69, 0x88, 0xc9,
+  0xfa, 0x90, 0x03, 0x29, 0x0f, 0x60, 0xa9, 0xff, 0x60, 0xa9, 0x20, 0x4c,
+  0xef, 0xff, 0xa9, 0x0d, 0x4c, 0xef, 0xff, 0xe6, 0x1d, 0xad, 0x11, 0xd0,
+  0x10, 0xf9, 0xad, 0x10, 0xd0, 0x29, 0x7f, 0x60, 0xb0, 0xa9, 0x00, 0xaa,
+  0x20, 0xef, 0xff, 0xe8, 0x8a, 0x4c, 0x02, 0x00, 0x5f, 0x00, 0x08, 0x00,
+  0x10, 0x00, 0x01, 0x00, 0x0d, 0x14, 0xed, 0x01, 0x00, 0x0f, 0x28, 0x00,
+  0x0c, 0x9f, 0x7d, 0x7d, 0x7d, 0x36, 0x9c, 0x24, 0x82, 0xf6, 0xff, 0x28,
+  0x00, 0x0c, 0xfd, 0x01, 0x07, 0x1a, 0x22, 0x22, 0x23, 0x22, 0x02, 0x02,
+  0xff, 0x07, 0x07, 0x35, 0x0f, 0x00, 0x08, 0x82, 0x21, 0x00, 0xf5, 0x03,
+  0x08, 0x02, 0x00, 0x10, 0x35, 0x0f, 0xfb, 0x0f, 0x1b, 0x36, 0x3d, 0x3d,
+  0x3e, 0x3d, 0x0a, 0x0a, 0x07, 0x0c, 0x24, 0x00, 0x50, 0x00, 0x00, 0x20,
+  0x00, 0xed, 0xf5, 0x40, 0x1b, 0x0a, 0x00, 0x5d, 0xa0, 0xd3, 0xc9, 0xc5,
+  0xd6, 0xc5, 0xa0, 0xcf, 0xc6, 0xa0, 0xc5, 0xd2, 0xc1, 0xd4, 0xcf, 0xd3,
+  0xd4, 0xc8, 0xc5, 0xce, 0xc5, 0xd3, 0x01, 0x0b, 0x14, 0x00, 0x4f, 0xc6,
+  0x34, 0xb5, 0xf4, 0x01, 0x72, 0x01, 0x0f, 0x1e, 0x00, 0xce, 0x71, 0xb5,
+  0xf4, 0x01, 0x03, 0xc3, 0x71, 0xb0, 0x00, 0x00, 0x01, 0x18, 0x28, 0x00,
+  0x55, 0xc9, 0x56, 0xb2, 0x02, 0x00, 0x57, 0xce, 0x03, 0xc6, 0x2d, 0xc9,
+  0x72, 0x71, 0xb1, 0x01, 0x00, 0x03, 0x59, 0xc9, 0x01, 0x0c, 0x32, 0x18,
+  0x00, 0x50, 0x01, 0x11, 0x3c, 0x00, 0x60, 0x1c, 0x00, 0xf0, 0x01, 0x16,
+  0xb0, 0x00, 0x00, 0x24, 0xb1, 0x6e, 0x00, 0x01, 0x13, 0x46, 0x00, 0xc3,
+  0x71, 0xc3, 0x12, 0x2b, 0x00, 0xf1, 0x02, 0x62, 0xc9, 0x45, 0x28, 0xa0,
+  0x29, 0x47, 0x01, 0x0e, 0x50, 0x00, 0x60, 0xc9, 0x19, 0xce, 0x15, 0xc9,
+  0x21, 0x00, 0xf0, 0x03, 0x1a, 0x5a, 0x00, 0x55, 0xca, 0x56, 0xc9, 0x14,
+  0xc9, 0x57, 0xce, 0x58, 0xc9, 0x03, 0xc6, 0x2d, 0xca, 0x72, 0x6d, 0x00,
+  0xf0, 0x1b, 0x03, 0x59, 0xca, 0x01, 0x06, 0x6e, 0x00, 0x59, 0xc9, 0x01,
+  0x1b, 0x78, 0x00, 0x63, 0x03, 0x62, 0xc3, 0x45, 0x28, 0xa0, 0xd0, 0xd2,
+  0xc9, 0xcd, 0xc5, 0xd3, 0xa0, 0xd5, 0xd0, 0xa0, 0xd4, 0xcf, 0xa0, 0x29,
+  0x46, 0xce, 0x01, 0x05, 0x82, 0x00, 0x51, 0x01, 0x5f, 0x00, 0x08, 0x00,
+  0x10, 0x00, 0x01, 0x00, 0x0c, 0x10, 0xed, 0x01, 0x00, 0x10, 0xec, 0x05,
+  0x00, 0x0f, 0x28, 0x00, 0x0b, 0xaf, 0x82, 0x82, 0x88, 0x7d, 0x8a, 0xaa,
+  0x90, 0x82, 0xf6, 0xff, 0x28, 0x00, 0x0b, 0xfd, 0x02, 0x0a, 0x15, 0x1a,
+  0x0e, 0x16, 0x36, 0x0e, 0x02, 0x02, 0xff, 0x0a, 0x0a, 0x3d, 0x0e, 0x00,
+  0x08, 0xe6, 0x22, 0x00, 0xf5, 0x03, 0x0b, 0x02, 0x00, 0x10, 0x3d, 0x0e,
+  0xfb, 0x0f, 0x2f, 0x33, 0x41, 0x43, 0x63, 0x41, 0x0d, 0x0d, 0x0a, 0x0f,
+  0x24, 0x00, 0x50, 0x00, 0x00, 0x20, 0x00, 0xed, 0xf0, 0x61, 0x1a, 0x0a,
+  0x00, 0x5d, 0xa0, 0xce, 0xd5, 0xcd, 0xc2, 0xc5, 0xd2, 0xa0, 0xc7, 0xd5,
+  0xc5, 0xd3, 0xd3, 0xc9, 0xce, 0xc7, 0xa0, 0xc7, 0xc1, 0xcd, 0xc5, 0x01,
+  0x14, 0x14, 0x00, 0x4e, 0xce, 0x40, 0x22, 0xb2, 0x14, 0x00, 0x72, 0x43,
+  0xc1, 0x40, 0x22, 0xb3, 0x03, 0x00, 0x72, 0x01, 0x1d, 0x1e, 0x00, 0x61,
+  0x28, 0xd7, 0xc8, 0xc1, 0xd4, 0xa0, 0xc9, 0xd3, 0xa0, 0xd9, 0xcf, 0xd5,
+  0xd2, 0xa0, 0xce, 0xc1, 0xcd, 0xc5, 0x29, 0x47, 0x03, 0x52, 0xce, 0x40,
+  0x01, 0x16, 0x28, 0x00, 0xd3, 0x71, 0x2f, 0x3f, 0xb1, 0x64, 0x00, 0x72,
+  0x12, 0xb1, 0x01, 0x00, 0x03, 0xd4, 0x71, 0xb0, 0x00, 0x00, 0x01, 0x33,
+  0x32, 0x00, 0x61, 0x28, 0xc9, 0xa0, 0xc1, 0xcd, 0xa0, 0xd4, 0xc8, 0xc9,
+  0xce, 0xcb, 0x5f, 0x00, 0x44, 0xcf, 0xc6, 0xa0, 0xc1, 0x74, 0x00, 0xf1,
+  0x0a, 0xc6, 0xd2, 0xcf, 0xcd, 0xa0, 0xb1, 0xa0, 0xd4, 0xcf, 0xa0, 0xb1,
+  0xb0, 0xb0, 0xac, 0xa0, 0x29, 0x45, 0xce, 0x40, 0x01, 0x1d, 0x3c, 0x00,
+  0x61, 0x28, 0x5e, 0x00, 0x01, 0x92, 0x00, 0x90, 0x29, 0x47, 0x03, 0x54,
+  0xc7, 0x03, 0xd4, 0x71, 0xd4, 0x56, 0x00, 0xf4, 0x04, 0x01, 0x23, 0x46,
+  0x00, 0x60, 0xc7, 0x1c, 0xb1, 0x01, 0x00, 0x1e, 0xc7, 0x19, 0xb1, 0x64,
+  0x00, 0x25, 0x61, 0x28, 0x3e, 0x00, 0xb0, 0xa0, 0xd0, 0xcc, 0xc5, 0xc1,
+  0xd3, 0xc5, 0x29, 0x01, 0x13, 0x50, 0x23, 0x00, 0xf4, 0x04, 0xd3, 0x25,
+  0x61, 0x28, 0xd4, 0xcf, 0xcf, 0xa0, 0xcc, 0xcf, 0xd7, 0x29, 0x01, 0x14,
+  0x5a, 0x00, 0x60, 0xc7, 0x19, 0x13, 0x00, 0xf0, 0x1a, 0xc8, 0xc9, 0xc7,
+  0xc8, 0x29, 0x01, 0x0c, 0x64, 0x00, 0x60, 0xc7, 0x17, 0xd3, 0x24, 0xb6,
+  0x3c, 0x00, 0x01, 0x08, 0x6e, 0x00, 0x5c, 0xb2, 0xc8, 0x00, 0x01, 0x16,
+  0x78, 0x00, 0x61, 0x28, 0xd0, 0xcc, 0xc1, 0xd9, 0xa0, 0xc1, 0xc7, 0xc1,
+  0xc9, 0xce, 0xda, 0x00, 0xf2, 0x14, 0xc1, 0x40, 0x01, 0x18, 0x82, 0x00,
+  0x60, 0xc1, 0x40, 0x2a, 0xb1, 0x01, 0x00, 0x23, 0xb1, 0x01, 0x00, 0x72,
+  0x39, 0x28, 0xd9, 0x29, 0x24, 0xb4, 0x28, 0x00, 0x01, 0x19, 0x8c, 0x00,
+  0x61, 0x28, 0xc2, 0xd9, 0xc5, 0xb8, 0x00, 0x01, 0x20, 0x00, 0xf2, 0x10,
+  0x3b, 0xce, 0x40, 0x72, 0x72, 0x01, 0x05, 0x96, 0x00, 0x51, 0x01, 0x1e,
+  0xc8, 0x00, 0x61, 0x28, 0xc7, 0xcf, 0xd4, 0xa0, 0xc9, 0xd4, 0xa0, 0xc9,
+  0xce, 0xa0, 0x29, 0x46, 0xd4, 0x45, 0x28, 0xd2, 0x00, 0xc0, 0xc5, 0xd3,
+  0x29, 0x01, 0x18, 0xd2, 0x00, 0x60, 0xd4, 0x1a, 0xb7, 0x07, 0xc2, 0x00,
+  0xf2, 0x03, 0xd7, 0xc5, 0xcc, 0xcc, 0xa0, 0xc4, 0xcf, 0xce, 0xc5, 0xa1,
+  0x29, 0x01, 0x2d, 0xdc, 0x00, 0x60, 0xd4, 0x19, 0x18, 0x00, 0x80, 0xd4,
+  0xd2, 0xd9, 0xa0, 0xc8, 0xc1, 0xcc, 0xd6, 0x35, 0x01, 0xf0, 0x0b, 0xd4,
+  0xc8, 0xc5, 0xa0, 0xd2, 0xc1, 0xce, 0xc7, 0xc5, 0xa0, 0xc5, 0xc1, 0xc3,
+  0xc8, 0xa0, 0xd4, 0xc9, 0xcd, 0xc5, 0x29, 0x01, 0x05, 0xe6, 0x00, 0x5b,
+  0x01,
+};
+
+static const library_segment_t library_segments[] = {
+    {0x0300, 557, 0, 536},
+    {0x0000, 11, 536, 12},
+    {0x004A, 182, 548, 78},
+    {0x0F35, 203, 626, 198},
+    {0x004A, 182, 824, 84},
+    {0x0E3D, 451, 908, 425},
+};
+
+static const library_entry_t library_entries[] = {
+    {"cellular", "Cellular Automaton", 0x0300, LIBRARY_BOOT, 1, 0},
+    {"charset", "Character set test", 0x0000, 0, 1, 1},
+    {"basic", "Integer BASIC", 0xE000, 0, 0, 2},
+    {"primes", "Primes to 500 (BASIC)", 0xE2B3, 0, 2, 2},
+    {"guess", "Number guessing game (BASIC)", 0xE2B3, 0, 2, 4},
+};
+
+#endif // LIBRARY_BLOB_H
@@ -0,0 +1,82 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include <stdint.h>
+
+#define APPLE1_CLOCK_HZ 1023000 // Apple-1 6502 clock
+
+// Speed multiplier used by PACING_TURBO
+#ifndef PACING_TURBO_MULTIPLIER
+#define PACING_TURBO_MULTIPLIER 4
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum
+    {
+        PACING_AUTHENTIC,   // 1.023 MHz, like the real machine
+        PACING_TURBO,       // PACING_TURBO_MULTIPLIER x 1.023 MHz
+        PACING_UNTHROTTLED, // As fast as the host can go
+        PACING_MODE_COUNT
+    } pacing_mode_t;
+
+    typedef struct
+    {
+        uint32_t window_us;   // Time covered by these stats
+        uint64_t cycles;      // Cycles executed in the window
+        int32_t drift_us;     // Emulated time minus wall time, now
+        int32_t drift_min_us; // Range of drift seen at slice starts
+        int32_t drift_max_us;
+        uint32_t jitter_us;   // Standard deviation of drift at slice starts
+        uint32_t slices;      // Number of slices run
+        uint32_t dropped_us;  // Lag given up because it couldn't be caught up
+    } pacing_stats_t;
+
+    // The schedule of one emulated CPU; each machine has its own
+    typedef struct
+    {
+        pacing_mode_t mode;
+        uint32_t clock_hz;
+        uint32_t last_us;
+        uint64_t credit_rem; // Fraction of a cycle carried between calls
+        int64_t debt;        // Cycles owed to the schedule (>0 = behind)
+
+        // Stats for the current window
+        uint32_t window_start_us;
+        uint64_t window_cycles;
+        uint32_t window_slices;
+        uint32_t window_dropped_us;
+        int32_t drift_min_us;
+        int32_t drift_max_us;
+        int64_t drift_sum;
+        int64_t drift_sum_sq;
+        uint32_t drift_samples;
+    } pacing_t;
+
+    void pacing_init(pacing_t *p, uint32_t now_us);
+    void pacing_set_mode(pacing_t *p, pacing_mode_t mode, uint32_t now_us);
+    pacing_mode_t pacing_get_mode(const pacing_t *p);
+    const char *pacing_mode_name(pacing_mode_t mode);
+
+    // Cycles the CPU should run now to keep up with wall time; 0 when it
+    // is ahead of schedule and the caller can sleep
+    uint32_t pacing_budget(pacing_t *p, uint32_t now_us);
+
+    // Record the cycles actually run after a pacing_budget() slice
+    void pacing_account(pacing_t *p, uint32_t cycles);
+
+    // Count the time since the last call as run, for a CPU that was parked
+    // in a loop it would only have spun in
+    void pacing_fast_forward(pacing_t *p, uint32_t now_us);
+
+    // Fill in the stats for the window since the last call and start a new one
+    void pacing_get_stats(pacing_t *p, pacing_stats_t *stats, uint32_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PACING_H
@@ -0,0 +1,36 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "emulator.h"
+
+// Execution profile, built in with -DFAKE6502_PROFILE: instructions per PC
+// (RAM and the ROMs), instructions and cycles per opcode, and accesses to
+// the four PIA registers. Without the flag none of it is compiled and
+// step6502()/run6502() are unchanged.
+
+#ifndef PROFILE_TOP
+#define PROFILE_TOP 10 // Addresses and opcodes listed by profile_print()
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Start over, profiling machine `m` only; the first call allocates the
+    // PC histogram
+    void profile_clear(apple1_t *m);
+
+    // Called by io_read()/io_write() for every access to the I/O page
+    void profile_io(const cpu6502_t *cpu, uint16_t address, int write);
+
+    // Print the PROFILE_TOP hottest addresses and opcodes and the I/O
+    // counts since the last profile_clear(), then clear. If another machine
+    // was being profiled, start profiling `m` instead.
+    void profile_print(apple1_t *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROFILE_H
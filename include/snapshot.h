@@ -0,0 +1,57 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "emulator.h"
+
+// Machine snapshots: the 6502 registers, the keyboard latch, the screen and
+// RAM. RAM is stored as a delta against the state setup_emulator() leaves
+// it in (zero, plus the library's boot programs), and the screen against
+// blanks, so a snapshot of BASIC with a program loaded is a few hundred
+// bytes. Where it is kept is up to the backend: LittleFS on the board, a
+// file on the host.
+
+#define SNAPSHOT_VERSION 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        // Open `name` for reading, or for writing (replacing it); NULL on
+        // failure
+        void *(*open)(const char *name, int write);
+        // Bytes actually read or written
+        uint32_t (*read)(void *file, uint8_t *data, uint32_t len);
+        uint32_t (*write)(void *file, const uint8_t *data, uint32_t len);
+        void (*close)(void *file);
+    } snapshot_backend_t;
+
+    typedef enum
+    {
+        SNAPSHOT_OK = 0,
+        SNAPSHOT_IO_ERROR = -1,      // Couldn't open, read or write it
+        SNAPSHOT_BAD_FILE = -2,      // Not a snapshot, or truncated
+        SNAPSHOT_OTHER_MACHINE = -3, // Taken with other RAM or boot programs
+        SNAPSHOT_NO_MEMORY = -4,     // No heap for the boot image
+    } snapshot_error_t;
+
+    // Save machine `m` under `name`. Returns the size written, or a
+    // snapshot_error_t. Call between run_emulator() slices with the CPU
+    // side held; the display is read too.
+    int32_t snapshot_save(apple1_t *m, const snapshot_backend_t *backend, const char *name);
+
+    // Put the machine back as saved. The whole snapshot is checked before
+    // anything is changed. Returns its size, or a snapshot_error_t. Same
+    // rules as snapshot_save().
+    int32_t snapshot_restore(apple1_t *m, const snapshot_backend_t *backend,
+                             const char *name);
+
+    const char *snapshot_error_name(int32_t error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAPSHOT_H
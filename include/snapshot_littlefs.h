@@ -0,0 +1,10 @@
+#ifndef SNAPSHOT_LITTLEFS_H
+#define SNAPSHOT_LITTLEFS_H
+
+#include "snapshot.h"
+
+// Snapshots as files on the ESP32's LittleFS partition, which is mounted
+// (and formatted, the first time) on first use
+extern const snapshot_backend_t snapshot_littlefs_backend;
+
+#endif // SNAPSHOT_LITTLEFS_H
@@ -0,0 +1,68 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+
+// Lock-free single-producer / single-consumer byte ring. One side may only
+// push and the other only pop; they can run on different cores without a
+// mutex. head and tail run freely and are masked on access, so the storage
+// size must be a power of two.
+
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t mask; // Size - 1
+    uint32_t head; // Next slot to write, only written by the producer
+    uint32_t tail; // Next slot to read, only written by the consumer
+} spsc_queue_t;
+
+// Initialiser for a queue over a static array, e.g.
+//   static uint8_t storage[64];
+//   static spsc_queue_t q = SPSC_QUEUE_INIT(storage);
+#define SPSC_QUEUE_INIT(storage) {(storage), sizeof(storage) - 1, 0, 0}
+
+static inline uint32_t spsc_count(const spsc_queue_t *q)
+{
+    return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t spsc_free(const spsc_queue_t *q)
+{
+    return q->mask + 1 - spsc_count(q);
+}
+
+// Producer side. Returns 0 if the queue is full.
+static inline int spsc_push(spsc_queue_t *q, uint8_t value)
+{
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) > q->mask)
+    {
+        return 0;
+    }
+    q->buf[head & q->mask] = value;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Consumer side. Returns 0 if the queue is empty.
+static inline int spsc_pop(spsc_queue_t *q, uint8_t *value)
+{
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    *value = q->buf[tail & q->mask];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Consumer side: drop everything queued so far
+static inline void spsc_clear(spsc_queue_t *q)
+{
+    __atomic_store_n(&q->tail, __atomic_load_n(&q->head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+}
+
+#endif // SPSC_QUEUE_H
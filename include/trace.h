@@ -0,0 +1,33 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "emulator.h"
+
+// Instruction trace, built in with -DFAKE6502_TRACE: a ring of the last
+// TRACE_RECORDS instructions step6502()/run6502() ran, each with the
+// registers it left. trace_print() dumps it as raw hex for "program trace"
+// on the host to disassemble.
+
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS 256 // Power of two; 8 bytes each
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Empty the ring and trace machine `m` from now on
+    void trace_clear(const apple1_t *m);
+
+    // One line per record, oldest first, between [TRACE ...] and
+    // [TRACE end]. The opcode and operand bytes are read from m's memory
+    // now, so code that has changed since shows as it is now. Only the
+    // traced machine has a trace; for another, tracing moves to `m`.
+    void trace_print(apple1_t *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
@@ -1,7 +1,7 @@
 #ifndef WOZMON_ROM_H
 #define WOZMON_ROM_H
 
-unsigned char wozmon_rom[] = {
+const unsigned char wozmon_rom[] = {
 0xD8, 0x58, 0xA0, 0x7F, 0x8C, 0x12, 0xD0, 0xA9, 0xA7, 0x8D, 0x11, 0xD0, 0x8D, 0x13, 0xD0, 0xC9,
     0xDF, 0xF0, 0x13, 0xC9, 0x9B, 0xF0, 0x03, 0xC8, 0x10, 0x0F, 0xA9, 0xDC, 0x20, 0xEF, 0xFF, 0xA9,
     0x8D, 0x20, 0xEF, 0xFF, 0xA0, 0x01, 0x88, 0x30, 0xF6, 0xAD, 0x11, 0xD0, 0x10, 0xFB, 0xAD, 0x10,
@@ -21,6 +21,6 @@ unsigned char wozmon_rom[] = {
     
 };
 
-unsigned int wozmon_rom_len = sizeof(wozmon_rom);
+const unsigned int wozmon_rom_len = sizeof(wozmon_rom);
 
 #endif
@@ -0,0 +1,19 @@
+10 REM NUMBER GUESSING GAME
+20 DIM N$(20),A$(3)
+30 PRINT "WHAT IS YOUR NAME";:INPUT N$
+40 S=RND(100)+1:T=0
+50 PRINT "I AM THINKING OF A NUMBER FROM 1 TO 100, ";N$
+60 PRINT "YOUR GUESS";:INPUT G:T=T+1
+70 IF G<1 OR G>100 THEN PRINT "1 TO 100 PLEASE"
+80 IF G<S THEN PRINT "TOO LOW"
+90 IF G>S THEN PRINT "TOO HIGH"
+100 IF G#S THEN 60
+110 GOSUB 200
+120 PRINT "PLAY AGAIN";:INPUT A$
+130 IF A$(1,1)="Y" THEN 40
+140 PRINT "BYE, ";N$(1,LEN(N$))
+150 END
+200 PRINT "GOT IT IN ";T;" GUESSES"
+210 IF T<=7 THEN PRINT "WELL DONE!"
+220 IF T>7 THEN PRINT "TRY HALVING THE RANGE EACH TIME"
+230 RETURN
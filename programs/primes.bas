@@ -0,0 +1,12 @@
+10 REM SIEVE OF ERATOSTHENES
+20 DIM F(500)
+30 N=500:C=0
+40 FOR I=2 TO N:F(I)=1:NEXT I
+50 FOR I=2 TO N
+60 IF F(I)=0 THEN 110
+70 C=C+1:PRINT I;" ";
+80 IF I>N/I THEN 110
+90 FOR J=I*I TO N STEP I:F(J)=0:NEXT J
+110 NEXT I
+120 PRINT:PRINT C;" PRIMES UP TO ";N
+130 END
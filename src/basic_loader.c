@@ -0,0 +1,77 @@
+#include "basic_loader.h"
+#include "emulator.h"
+#include <string.h>
+
+#define BASIC_COLD_START 0xE000
+#define MAX_CYCLES 100000000 // Far more than any program needs; BASIC has hung
+
+typedef struct
+{
+    basic_load_result_t *result;
+    char out_line[40]; // BASIC's current output line
+    uint32_t out_len;
+} capture_t;
+
+static uint16_t peek16(apple1_t *m, uint16_t address)
+{
+    return read_memory(m, address) | read_memory(m, address + 1) << 8;
+}
+
+// Output of the headless run; only error messages are kept
+static void capture(void *context, char c)
+{
+    capture_t *cap = context;
+    basic_load_result_t *result = cap->result;
+    if (c != '\r')
+    {
+        if (cap->out_len < sizeof(cap->out_line) - 1)
+        {
+            cap->out_line[cap->out_len++] = c;
+        }
+        return;
+    }
+
+    cap->out_line[cap->out_len] = '\0';
+    cap->out_len = 0;
+    if (strncmp(cap->out_line, "*** ", 4) == 0)
+    {
+        if (result->errors++ == 0)
+        {
+            uint32_t n = strlen(cap->out_line);
+            if (n >= sizeof(result->first_error))
+            {
+                n = sizeof(result->first_error) - 1;
+            }
+            memcpy(result->first_error, cap->out_line, n);
+            result->first_error[n] = '\0';
+        }
+    }
+}
+
+int basic_load(apple1_t *m, const char *text, uint32_t len, int new_program,
+               basic_load_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    capture_t cap = {r, {0}, 0};
+
+    // Run the cold start up to its first prompt
+    if (new_program)
+    {
+        emulator_run_from(m, BASIC_COLD_START);
+        r->cycles += emulator_type_headless(m, text, 0, capture, &cap, MAX_CYCLES);
+        if (!emulator_waiting_for_key(m))
+        {
+            return 0;
+        }
+    }
+    r->cycles += emulator_type_headless(m, text, len, capture, &cap, MAX_CYCLES);
+
+    // Lines end in LF, CR LF or CR
+    for (uint32_t i = 0; i < len; i++)
+    {
+        r->lines += text[i] == '\n' || (text[i] == '\r' && (i + 1 == len || text[i + 1] != '\n'));
+    }
+    r->program_start = peek16(m, BASIC_PP);
+    r->program_end = peek16(m, BASIC_HIMEM);
+    return emulator_waiting_for_key(m);
+}
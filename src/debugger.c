@@ -0,0 +1,452 @@
+#ifdef FAKE6502_DEBUG
+
+#include "debugger.h"
+#include "disasm6502.h"
+#include "emulator.h"
+#include "fake6502.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_SIZE 40
+#define DUMP_BYTES 64   // m without a length
+#define LIST_LINES 8    // l without a count
+#define MAX_STEPS 1000  // s N
+
+static const char help[] =
+    "r                  registers\n"
+    "m ADDR [N]         memory\n"
+    "l [ADDR] [N]       disassemble (from PC)\n"
+    "b [ADDR]           set breakpoint / list\n"
+    "d ADDR             delete breakpoint\n"
+    "w [ADDR[.END] [r|w|rw]]  watch (writes) / list\n"
+    "u ADDR             remove the watch starting at ADDR\n"
+    "s [N]              step\n"
+    "c                  continue\n";
+
+typedef struct
+{
+    uint16_t start, end;
+    uint8_t flags; // WATCH_READ, WATCH_WRITE
+} watch_t;
+
+static watch_t watches[MAX_WATCHES];
+static int num_watches;
+
+// First watchpoint access in the current batch or step
+static struct
+{
+    int pending;
+    uint16_t address;
+    uint8_t value;
+    uint8_t write;
+} hit;
+
+// The machine being debugged: the last one broken into or stopped. The
+// watches are mapped on it; breakpoints belong to each machine's 6502.
+static apple1_t *machine;
+static cpu6502_t *cpu;
+
+static int halted; // Read by the serial side
+static char line[LINE_SIZE];
+static int line_len;
+static char last_key;
+
+int debugger_halted(const apple1_t *m)
+{
+    return __atomic_load_n(&halted, __ATOMIC_ACQUIRE) && m == machine;
+}
+
+static void set_halted(int value)
+{
+    __atomic_store_n(&halted, value, __ATOMIC_RELEASE);
+}
+
+static void print_flags(uint8_t p)
+{
+    const char *names = "NV-BDIZC";
+    for (int i = 0; i < 8; i++)
+    {
+        putchar(p & (0x80 >> i) ? names[i] : '.');
+    }
+}
+
+// Disassemble the instruction at `address`; returns its length
+static int print_instruction(uint16_t address)
+{
+    uint8_t bytes[3] = {read_memory(machine, address), read_memory(machine, address + 1),
+                        read_memory(machine, address + 2)};
+    char text[24];
+    int len = disasm6502(address, bytes, text, sizeof(text));
+    printf("%04X ", address);
+    for (int i = 0; i < 3; i++)
+    {
+        if (i < len)
+        {
+            printf(" %02X", bytes[i]);
+        }
+        else
+        {
+            printf("   ");
+        }
+    }
+    printf("  %s", text);
+    return len;
+}
+
+static void print_registers()
+{
+    printf("A=%02X X=%02X Y=%02X SP=%02X P=", cpu->a, cpu->x, cpu->y, cpu->sp);
+    print_flags(getP(cpu));
+    printf("  ");
+    print_instruction(cpu->pc);
+    putchar('\n');
+}
+
+static void prompt()
+{
+    printf("dbg> ");
+    fflush(stdout);
+}
+
+static void report_hit()
+{
+    if (hit.pending)
+    {
+        printf("[WATCH %s $%04X = $%02X, stopped at $%04X]\n", hit.write ? "write" : "read",
+               hit.address, hit.value, cpu->pc);
+        hit.pending = 0;
+    }
+}
+
+// Map each page of `m` with the union of the watches on it, or with none
+static void map_watches(apple1_t *m, int clear)
+{
+    uint8_t flags[256] = {0};
+    for (int i = 0; i < num_watches && !clear; i++)
+    {
+        for (uint32_t page = watches[i].start >> 8; page <= watches[i].end >> 8u; page++)
+        {
+            flags[page] |= watches[i].flags;
+        }
+    }
+    for (int page = 0; page < 256; page++)
+    {
+        emulator_watch_page(m, page, flags[page]);
+    }
+}
+
+// Debug `m` from now on, moving the watches over to it
+static void attach(apple1_t *m)
+{
+    if (m == machine)
+    {
+        return;
+    }
+    if (machine && num_watches)
+    {
+        map_watches(machine, 1);
+    }
+    machine = m;
+    cpu = emulator_cpu(m);
+    hit.pending = 0;
+    if (num_watches)
+    {
+        map_watches(m, 0);
+    }
+}
+
+void debugger_break(apple1_t *m)
+{
+    attach(m);
+    printf("\n[DEBUG]\n");
+    print_registers();
+    prompt();
+    line_len = 0;
+    set_halted(1);
+}
+
+void debugger_access(apple1_t *m, uint16_t address, uint8_t value, int write)
+{
+    if (hit.pending || m != machine)
+    {
+        return;
+    }
+    for (int i = 0; i < num_watches; i++)
+    {
+        const watch_t *w = &watches[i];
+        if (address >= w->start && address <= w->end &&
+            (w->flags & (write ? WATCH_WRITE : WATCH_READ)))
+        {
+            hit.pending = 1;
+            hit.address = address;
+            hit.value = value;
+            hit.write = write;
+            stop6502(cpu);
+            return;
+        }
+    }
+}
+
+int debugger_stopped(apple1_t *m)
+{
+    int at_breakpoint = emulator_cpu(m)->at_breakpoint;
+    if (!at_breakpoint && !(hit.pending && m == machine))
+    {
+        return 0;
+    }
+    attach(m);
+    if (at_breakpoint)
+    {
+        printf("\n[BREAK at $%04X]\n", cpu->pc);
+    }
+    else
+    {
+        putchar('\n');
+        report_hit();
+    }
+    print_registers();
+    prompt();
+    line_len = 0;
+    set_halted(1);
+    return 1;
+}
+
+static void list_breakpoints()
+{
+    int any = 0;
+    for (uint32_t pc = 0; pc < 0x10000; pc++)
+    {
+        if (is_breakpoint6502(cpu, pc))
+        {
+            printf("%s$%04X", any ? " " : "Breakpoints: ", (unsigned)pc);
+            any = 1;
+        }
+    }
+    printf("%s\n", any ? "" : "No breakpoints");
+}
+
+static void list_watches()
+{
+    if (num_watches == 0)
+    {
+        printf("No watches\n");
+    }
+    for (int i = 0; i < num_watches; i++)
+    {
+        printf("$%04X.$%04X %s%s\n", watches[i].start, watches[i].end,
+               watches[i].flags & WATCH_READ ? "r" : "", watches[i].flags & WATCH_WRITE ? "w" : "");
+    }
+}
+
+static void add_watch(const char *range, const char *mode)
+{
+    char *end;
+    uint16_t start = strtoul(range, &end, 16);
+    uint16_t last = *end == '.' ? strtoul(end + 1, NULL, 16) : start;
+    uint8_t flags = 0;
+    if (!mode || strpbrk(mode, "wW"))
+    {
+        flags |= WATCH_WRITE;
+    }
+    if (mode && strpbrk(mode, "rR"))
+    {
+        flags |= WATCH_READ;
+    }
+    if (last < start)
+    {
+        printf("Range is backwards\n");
+        return;
+    }
+    if (num_watches == MAX_WATCHES)
+    {
+        printf("No room, %d watches at most\n", MAX_WATCHES);
+        return;
+    }
+    watches[num_watches++] = (watch_t){start, last, flags};
+    map_watches(machine, 0);
+}
+
+static void remove_watch(uint16_t start)
+{
+    for (int i = 0; i < num_watches; i++)
+    {
+        if (watches[i].start == start)
+        {
+            watches[i] = watches[--num_watches];
+            map_watches(machine, 0);
+            return;
+        }
+    }
+    printf("No watch at $%04X\n", start);
+}
+
+static void dump_memory(uint16_t address, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint16_t a = address + i;
+        if (i == 0 || (a & 7) == 0)
+        {
+            printf("%s%04X:", i ? "\n" : "", a);
+        }
+        printf(" %02X", read_memory(machine, a));
+    }
+    putchar('\n');
+}
+
+static void step(uint32_t n)
+{
+    for (uint32_t i = 0; i < n && !hit.pending; i++)
+    {
+        print_instruction(cpu->pc);
+        putchar('\n');
+        step_emulator(machine);
+    }
+    report_hit();
+    print_registers();
+}
+
+static void run_line()
+{
+    char *argv[4];
+    int argc = 0;
+    for (char *t = strtok(line, " "); t && argc < 4; t = strtok(NULL, " "))
+    {
+        argv[argc++] = t;
+    }
+    if (argc == 0)
+    {
+        return;
+    }
+
+    uint32_t arg1 = argc > 1 ? strtoul(argv[1], NULL, 16) : 0;
+    switch (tolower((unsigned char)argv[0][0]))
+    {
+    case 'r':
+        print_registers();
+        break;
+
+    case 'm':
+        if (argc < 2)
+        {
+            printf("m ADDR [N]\n");
+            break;
+        }
+        dump_memory(arg1, argc > 2 ? strtoul(argv[2], NULL, 16) : DUMP_BYTES);
+        break;
+
+    case 'l':
+    {
+        uint16_t address = argc > 1 ? arg1 : cpu->pc;
+        uint32_t n = argc > 2 ? strtoul(argv[2], NULL, 16) : LIST_LINES;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            address += print_instruction(address);
+            putchar('\n');
+        }
+        break;
+    }
+
+    case 'b':
+        if (argc < 2)
+        {
+            list_breakpoints();
+        }
+        else if (!breakpoint6502(cpu, arg1, 1))
+        {
+            printf("Already set\n");
+        }
+        break;
+
+    case 'd':
+        if (argc < 2 || !breakpoint6502(cpu, arg1, 0))
+        {
+            printf("No breakpoint there\n");
+        }
+        break;
+
+    case 'w':
+        if (argc < 2)
+        {
+            list_watches();
+        }
+        else
+        {
+            add_watch(argv[1], argc > 2 ? argv[2] : NULL);
+        }
+        break;
+
+    case 'u':
+        if (argc < 2)
+        {
+            printf("u ADDR\n");
+            break;
+        }
+        remove_watch(arg1);
+        break;
+
+    case 's':
+    {
+        uint32_t n = argc > 1 ? arg1 : 1;
+        step(n < MAX_STEPS ? n : MAX_STEPS);
+        break;
+    }
+
+    case 'c':
+        // Get off a breakpoint at PC before letting run6502() go
+        step_emulator(machine);
+        if (hit.pending)
+        {
+            report_hit();
+            print_registers();
+            break;
+        }
+        set_halted(0);
+        printf("[RUN]\n");
+        return;
+
+    default:
+        printf("%s", help);
+        break;
+    }
+}
+
+void debugger_key(char c)
+{
+    char previous = last_key;
+    last_key = c;
+    if (c == '\n' && previous == '\r')
+    {
+        return; // CR LF
+    }
+    if (c == '\r' || c == '\n')
+    {
+        putchar('\n');
+        line[line_len] = 0;
+        line_len = 0;
+        run_line();
+        if (debugger_halted(machine))
+        {
+            prompt();
+        }
+        return;
+    }
+    if (c == 0x08 || c == 0x7F)
+    {
+        if (line_len > 0)
+        {
+            line_len--;
+            printf("\b \b");
+        }
+    }
+    else if (line_len < LINE_SIZE - 1 && c >= ' ')
+    {
+        line[line_len++] = c;
+        putchar(c);
+    }
+    fflush(stdout);
+}
+
+#endif // FAKE6502_DEBUG
@@ -0,0 +1,118 @@
+#include "disasm6502.h"
+#include <stdio.h>
+#include <string.h>
+
+// Three letters per opcode, in the order of fake6502's optable
+static const char mnemonics[] =
+    "BRKORAJAMSLONOPORAASLSLOPHPORAASLANCNOPORAASLSLO" // 0
+    "BPLORAJAMSLONOPORAASLSLOCLCORANOPSLONOPORAASLSLO" // 1
+    "JSRANDJAMRLABITANDROLRLAPLPANDROLANCBITANDROLRLA" // 2
+    "BMIANDJAMRLANOPANDROLRLASECANDNOPRLANOPANDROLRLA" // 3
+    "RTIEORJAMSRENOPEORLSRSREPHAEORLSRALRJMPEORLSRSRE" // 4
+    "BVCEORJAMSRENOPEORLSRSRECLIEORNOPSRENOPEORLSRSRE" // 5
+    "RTSADCJAMRRANOPADCRORRRAPLAADCRORARRJMPADCRORRRA" // 6
+    "BVSADCJAMRRANOPADCRORRRASEIADCNOPRRANOPADCRORRRA" // 7
+    "NOPSTANOPSAXSTYSTASTXSAXDEYNOPTXAANESTYSTASTXSAX" // 8
+    "BCCSTAJAMSHASTYSTASTXSAXTYASTATXSTASSHYSTASHXSHA" // 9
+    "LDYLDALDXLAXLDYLDALDXLAXTAYLDATAXLXALDYLDALDXLAX" // A
+    "BCSLDAJAMLAXLDYLDALDXLAXCLVLDATSXLASLDYLDALDXLAX" // B
+    "CPYCMPNOPDCPCPYCMPDECDCPINYCMPDEXSBXCPYCMPDECDCP" // C
+    "BNECMPJAMDCPNOPCMPDECDCPCLDCMPNOPDCPNOPCMPDECDCP" // D
+    "CPXSBCNOPISCCPXSBCINCISCINXSBCNOPSBCCPXSBCINCISC" // E
+    "BEQSBCJAMISCNOPSBCINCISCSEDSBCNOPISCNOPSBCINCISC"; // F
+
+// Addressing mode per opcode, from fake6502's addrtable: . implied,
+// A accumulator, # immediate, z/x/y zero page (,X ,Y), r relative,
+// a/X/Y absolute (,X ,Y), i indirect, ( (zp,X), ) (zp),Y
+static const char modes[] =
+    ".(.(zzzz.#A#aaaa" // 0
+    "r).)xxxx.Y.YXXXX" // 1
+    "a(.(zzzz.#A#aaaa" // 2
+    "r).)xxxx.Y.YXXXX" // 3
+    ".(.(zzzz.#A#aaaa" // 4
+    "r).)xxxx.Y.YXXXX" // 5
+    ".(.(zzzz.#A#iaaa" // 6
+    "r).)xxxx.Y.YXXXX" // 7
+    "#(#(zzzz.#.#aaaa" // 8
+    "r).)xxyy.Y.YXXYY" // 9
+    "#(#(zzzz.#.#aaaa" // A
+    "r).)xxyy.Y.YXXYY" // B
+    "#(#(zzzz.#.#aaaa" // C
+    "r).)xxxx.Y.YXXXX" // D
+    "#(#(zzzz.#.#aaaa" // E
+    "r).)xxxx.Y.YXXXX"; // F
+
+void mnemonic6502(uint8_t opcode, char name[4])
+{
+    memcpy(name, &mnemonics[opcode * 3], 3);
+    name[3] = 0;
+}
+
+int length6502(uint8_t opcode)
+{
+    switch (modes[opcode])
+    {
+    case '.':
+    case 'A':
+        return 1;
+    case 'a':
+    case 'X':
+    case 'Y':
+    case 'i':
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+int disasm6502(uint16_t pc, const uint8_t *bytes, char *out, size_t size)
+{
+    char name[4];
+    mnemonic6502(bytes[0], name);
+    uint8_t b = bytes[1];
+    uint16_t w = bytes[1] | bytes[2] << 8;
+
+    switch (modes[bytes[0]])
+    {
+    case '.':
+        snprintf(out, size, "%s", name);
+        break;
+    case 'A':
+        snprintf(out, size, "%s A", name);
+        break;
+    case '#':
+        snprintf(out, size, "%s #$%02X", name, b);
+        break;
+    case 'z':
+        snprintf(out, size, "%s $%02X", name, b);
+        break;
+    case 'x':
+        snprintf(out, size, "%s $%02X,X", name, b);
+        break;
+    case 'y':
+        snprintf(out, size, "%s $%02X,Y", name, b);
+        break;
+    case 'r':
+        snprintf(out, size, "%s $%04X", name, (uint16_t)(pc + 2 + (int8_t)b));
+        break;
+    case 'a':
+        snprintf(out, size, "%s $%04X", name, w);
+        break;
+    case 'X':
+        snprintf(out, size, "%s $%04X,X", name, w);
+        break;
+    case 'Y':
+        snprintf(out, size, "%s $%04X,Y", name, w);
+        break;
+    case 'i':
+        snprintf(out, size, "%s ($%04X)", name, w);
+        break;
+    case '(':
+        snprintf(out, size, "%s ($%02X,X)", name, b);
+        break;
+    case ')':
+        snprintf(out, size, "%s ($%02X),Y", name, b);
+        break;
+    }
+    return length6502(bytes[0]);
+}
@@ -1,17 +1,197 @@
 #include "display.h"
 #include <TFT_eSPI.h>
 #include <SPI.h>
+#include <string.h>
 
 TFT_eSPI tft = TFT_eSPI();
 
 static const int LINE_HEIGHT = 8; // Height of font 1 at size 1
-static int currentRow = 0;
-static int currentCol = 0;
+static const int CHAR_WIDTH = 6;  // Width of font 1 at size 1
 static unsigned long lastCursorBlink = 0;
 static bool cursorVisible = false;
 
-// Buffer to store screen content for scrolling
-static char screenBuffer[DISPLAY_ROWS][DISPLAY_COLS + 1];
+// A terminal's text and cursor. The screen is a ring of lines: screen row r
+// is held in screenBuffer[(topLine + r) % DISPLAY_ROWS], so scrolling only
+// moves topLine instead of copying every line up.
+typedef struct
+{
+    char screenBuffer[DISPLAY_ROWS][DISPLAY_COLS + 1];
+    int topLine;
+    int currentRow;
+    int currentCol;
+    int nl_count; // Consecutive newlines written
+} terminal_t;
+
+// Every terminal keeps its text; the shown one is on the panel and echoed
+// to serial
+static terminal_t terminals[DISPLAY_TERMINALS];
+static terminal_t *shown = &terminals[0];
+
+// What is currently drawn on the panel, by screen row. A frame only pushes
+// the cells of the dirty rows that differ from this.
+static char panelBuffer[DISPLAY_ROWS][DISPLAY_COLS];
+
+// Rows of the text model changed since the last frame. Writes only touch
+// screenBuffer and set these; display_update() renders them at most
+// DISPLAY_FPS times a second, so a burst of output costs one frame instead
+// of one SPI transaction per character.
+static bool rowDirty[DISPLAY_ROWS];
+static unsigned long lastFrame = 0;
+
+// Font 1 pre-rendered once as RGB565 tiles (green on black), stored in the
+// panel's byte order so rows built from them can be DMA'd as they are
+#define FIRST_GLYPH 0x20
+#define NUM_GLYPHS 96
+static uint16_t glyphAtlas[NUM_GLYPHS][LINE_HEIGHT][CHAR_WIDTH];
+
+// A text row is composed here and pushed with one DMA transfer; two buffers
+// so the next row can be composed while the previous one is being sent
+static uint16_t lineBuffer[2][LINE_HEIGHT * DISPLAY_COLS * CHAR_WIDTH];
+static int lineBufferIndex = 0;
+
+// Render through the atlas (default) or with tft.drawChar() per glyph, the
+// original path, kept for display_benchmark()
+static bool useAtlas = true;
+
+static inline char *screen_line(terminal_t *t, int row)
+{
+    return t->screenBuffer[(t->topLine + row) % DISPLAY_ROWS];
+}
+
+static inline void mark_dirty(const terminal_t *t, int row)
+{
+    if (t == shown)
+    {
+        rowDirty[row] = true;
+    }
+}
+
+static inline void mark_all_dirty()
+{
+    for (int row = 0; row < DISPLAY_ROWS; row++)
+    {
+        rowDirty[row] = true;
+    }
+}
+
+// The character a cell should show, with the blinking cursor on top
+static inline char cell_char(int row, int col)
+{
+    if (cursorVisible && row == shown->currentRow && col == shown->currentCol)
+    {
+        return '@';
+    }
+    return screen_line(shown, row)[col];
+}
+
+static inline uint16_t panel_color(uint16_t color)
+{
+    return (color >> 8) | (color << 8);
+}
+
+static void build_glyph_atlas()
+{
+    // font[] is TFT_eSPI's GLCD font: 5 column bytes per glyph, LSB at the
+    // top. drawChar() leaves the sixth column blank.
+    const uint16_t fg = panel_color(TFT_GREEN);
+    const uint16_t bg = panel_color(TFT_BLACK);
+
+    for (int g = 0; g < NUM_GLYPHS; g++)
+    {
+        for (int x = 0; x < CHAR_WIDTH; x++)
+        {
+            uint8_t bits = x < 5 ? pgm_read_byte(font + (FIRST_GLYPH + g) * 5 + x) : 0;
+            for (int y = 0; y < LINE_HEIGHT; y++)
+            {
+                glyphAtlas[g][y][x] = (bits >> y) & 1 ? fg : bg;
+            }
+        }
+    }
+}
+
+// Compose columns [lo, hi) of a row from the atlas and DMA them to the panel
+static void push_span(int row, int lo, int hi)
+{
+    int width = (hi - lo) * CHAR_WIDTH;
+    uint16_t *buf = lineBuffer[lineBufferIndex];
+    lineBufferIndex ^= 1;
+
+    for (int col = lo; col < hi; col++)
+    {
+        int g = (uint8_t)panelBuffer[row][col] - FIRST_GLYPH;
+        if (g < 0 || g >= NUM_GLYPHS)
+        {
+            g = 0; // Space
+        }
+
+        uint16_t *dst = buf + (col - lo) * CHAR_WIDTH;
+        for (int y = 0; y < LINE_HEIGHT; y++)
+        {
+            memcpy(dst + y * width, glyphAtlas[g][y], sizeof(glyphAtlas[g][y]));
+        }
+    }
+
+    // Waits for the previous transfer, which used the other buffer
+    tft.pushImageDMA((int32_t)lo * CHAR_WIDTH, row * LINE_HEIGHT, width, LINE_HEIGHT, buf);
+}
+
+// Bring one dirty row of the panel up to date with the model. Everything
+// between the first and last changed cell goes out as a single run.
+static bool render_row(int row, bool started)
+{
+    int lo = DISPLAY_COLS;
+    int hi = 0;
+
+    for (int col = 0; col < DISPLAY_COLS; col++)
+    {
+        char c = cell_char(row, col);
+        if (c != panelBuffer[row][col])
+        {
+            panelBuffer[row][col] = c;
+            if (col < lo)
+            {
+                lo = col;
+            }
+            hi = col + 1;
+
+            if (!useAtlas)
+            {
+                tft.drawChar(col * CHAR_WIDTH, row * LINE_HEIGHT, c, TFT_GREEN, TFT_BLACK, 1);
+            }
+        }
+    }
+    rowDirty[row] = false;
+
+    if (useAtlas && lo < hi)
+    {
+        if (!started)
+        {
+            tft.startWrite();
+            started = true;
+        }
+        push_span(row, lo, hi);
+    }
+    return started;
+}
+
+void display_flush()
+{
+    bool started = false;
+
+    for (int row = 0; row < DISPLAY_ROWS; row++)
+    {
+        if (rowDirty[row])
+        {
+            started = render_row(row, started);
+        }
+    }
+
+    // endWrite() waits for the last transfer to finish
+    if (started)
+    {
+        tft.endWrite();
+    }
+}
 
 void display_init()
 {
@@ -19,6 +199,10 @@ void display_init()
     tft.setRotation(1);
     tft.fillScreen(TFT_BLACK);
 
+    tft.setSwapBytes(false); // The atlas is already in panel byte order
+    tft.initDMA();
+    build_glyph_atlas();
+
     // Turn on backlight
     pinMode(4, OUTPUT);
     digitalWrite(4, HIGH);
@@ -29,75 +213,93 @@ void display_init()
     tft.setTextSize(1); // Use base size for smaller text
     tft.setCursor(0, 0);
 
-    currentRow = 0;
-    currentCol = 0;
-
-    display_clear();
+    for (int i = DISPLAY_TERMINALS - 1; i >= 0; i--)
+    {
+        shown = &terminals[i];
+        display_clear();
+    }
 }
 
 void display_clear()
 {
     tft.fillScreen(TFT_BLACK);
     tft.setCursor(0, 0);
-    currentRow = 0;
-    currentCol = 0;
+    shown->currentRow = 0;
+    shown->currentCol = 0;
+    shown->topLine = 0;
 
     // Clear the screen buffer
     for (int i = 0; i < DISPLAY_ROWS; i++)
     {
         for (int j = 0; j < DISPLAY_COLS; j++)
         {
-            screenBuffer[i][j] = ' ';
+            shown->screenBuffer[i][j] = ' ';
+            panelBuffer[i][j] = ' ';
         }
-        screenBuffer[i][DISPLAY_COLS] = '\0';
+        shown->screenBuffer[i][DISPLAY_COLS] = '\0';
+        rowDirty[i] = false;
     }
 }
 
-static void scroll_screen()
+void display_show(int terminal)
 {
-    // Shift buffer contents up by one line
-    for (int i = 0; i < DISPLAY_ROWS - 1; i++)
+    if (terminal < 0 || terminal >= DISPLAY_TERMINALS || shown == &terminals[terminal])
     {
-        for (int j = 0; j < DISPLAY_COLS; j++)
-        {
-            screenBuffer[i][j] = screenBuffer[i + 1][j];
-        }
+        return;
     }
+    shown = &terminals[terminal];
+
+    // The next frame redraws the cells that differ between the two
+    cursorVisible = false;
+    mark_all_dirty();
+}
+
+int display_shown()
+{
+    return shown - terminals;
+}
+
+static void scroll_screen(terminal_t *t)
+{
+    // Rotate the ring by one line; the old top line becomes the new bottom
+    t->topLine = (t->topLine + 1) % DISPLAY_ROWS;
 
     // Clear the last line in buffer
+    char *last = screen_line(t, DISPLAY_ROWS - 1);
     for (int j = 0; j < DISPLAY_COLS; j++)
     {
-        screenBuffer[DISPLAY_ROWS - 1][j] = ' ';
+        last[j] = ' ';
     }
 
-    // Redraw all lines - text background color handles clearing automatically
-    for (int i = 0; i < DISPLAY_ROWS; i++)
+    // Every row moved; the next frame redraws only the cells whose character
+    // changed. The panel is used in landscape, where the ST7789's hardware
+    // scroll (VSCRSADD) moves along the screen's x axis, so lines have to be
+    // redrawn; most cells of typical output are blank in both lines.
+    if (t == shown)
     {
-        tft.setCursor(0, i * LINE_HEIGHT);
-        for (int j = 0; j < DISPLAY_COLS; j++)
-        {
-            tft.print(screenBuffer[i][j]);
-        }
+        mark_all_dirty();
     }
 
     // Position cursor at start of last line
-    currentRow = DISPLAY_ROWS - 1;
-    currentCol = 0;
-    tft.setCursor(0, currentRow * LINE_HEIGHT);
+    t->currentRow = DISPLAY_ROWS - 1;
+    t->currentCol = 0;
 }
 
-void display_write_char(char c)
+static void put_char(terminal_t *t, char c);
+
+void display_terminal_write_char(int terminal, char c)
 {
-    static int nl_count = 0;
+    if (terminal < 0 || terminal >= DISPLAY_TERMINALS)
+    {
+        return;
+    }
+    terminal_t *t = &terminals[terminal];
 
-    // Erase cursor if it's currently visible
-    if (cursorVisible)
+    // Hide the cursor; the next frame erases it
+    if (t == shown && cursorVisible)
     {
-        const int charWidth = 6;
-        int cursor_x = currentCol * charWidth;
-        int cursor_y = currentRow * LINE_HEIGHT;
-        tft.fillRect(cursor_x, cursor_y, charWidth, LINE_HEIGHT, TFT_BLACK);
         cursorVisible = false;
+        rowDirty[t->currentRow] = true;
     }
 
     // Suppress DEL (0x7F) and other control characters except CR and LF
@@ -114,34 +316,44 @@ void display_write_char(char c)
     // This allows: command[NL][NL]output[NL] but suppresses extra [NL][NL]
     if (c == '\n')
     {
-        nl_count++;
-        if (nl_count > 2)
+        t->nl_count++;
+        if (t->nl_count > 2)
         {
             return; // Suppress 3rd and beyond consecutive newlines
         }
     }
     else
     {
-        nl_count = 0;
+        t->nl_count = 0;
     }
 
     // Echo to serial port
-    Serial.write(c);
+    if (t == shown)
+    {
+        Serial.write(c);
+    }
+
+    put_char(t, c);
+}
+
+void display_write_char(char c)
+{
+    display_terminal_write_char(display_shown(), c);
+}
 
+// Add a printable character or newline to the text model
+static void put_char(terminal_t *t, char c)
+{
     // Check if we need to wrap to next line (auto word wrap)
-    if (c != '\n' && currentCol >= DISPLAY_COLS)
+    if (c != '\n' && t->currentCol >= DISPLAY_COLS)
     {
-        currentRow++;
-        currentCol = 0;
+        t->currentRow++;
+        t->currentCol = 0;
 
         // Scroll if we're past the last row
-        if (currentRow >= DISPLAY_ROWS)
-        {
-            scroll_screen();
-        }
-        else
+        if (t->currentRow >= DISPLAY_ROWS)
         {
-            tft.setCursor(0, currentRow * LINE_HEIGHT);
+            scroll_screen(t);
         }
     }
 
@@ -149,32 +361,91 @@ void display_write_char(char c)
     if (c == '\n')
     {
         // Fill rest of current line with spaces in buffer
-        while (currentCol < DISPLAY_COLS)
+        char *line = screen_line(t, t->currentRow);
+        while (t->currentCol < DISPLAY_COLS)
         {
-            screenBuffer[currentRow][currentCol] = ' ';
-            currentCol++;
+            line[t->currentCol] = ' ';
+            t->currentCol++;
         }
+        mark_dirty(t, t->currentRow);
 
-        currentRow++;
-        currentCol = 0;
+        t->currentRow++;
+        t->currentCol = 0;
 
         // Scroll if we're past the last row
-        if (currentRow >= DISPLAY_ROWS)
+        if (t->currentRow >= DISPLAY_ROWS)
         {
-            scroll_screen();
+            scroll_screen(t);
         }
-        else
+    }
+    else
+    {
+        // Store character in buffer; the next frame draws it
+        screen_line(t, t->currentRow)[t->currentCol] = c;
+        mark_dirty(t, t->currentRow);
+        t->currentCol++;
+    }
+}
+
+void display_benchmark()
+{
+    // Wozmon-style dump lines, long enough to scroll many times
+    static const char sample[] = "E000: 4C B0 E2 AD 11 D0 10 FB\n"
+                                 "E008: AD 10 D0 60 8A 29 20 F0 23 A9 A0 85\n";
+    const int total = 4000;
+
+    // drawChar() renders every character as it arrives, as the display did
+    // before frames; the atlas pass renders at the frame rate like
+    // display_update()
+    for (int pass = 0; pass < 2; pass++)
+    {
+        useAtlas = pass == 1;
+        display_clear();
+
+        unsigned long start = micros();
+        unsigned long frame = start;
+        for (int i = 0; i < total; i++)
         {
-            tft.setCursor(0, currentRow * LINE_HEIGHT);
+            put_char(shown, sample[i % (sizeof(sample) - 1)]);
+            if (!useAtlas || micros() - frame >= 1000000UL / DISPLAY_FPS)
+            {
+                frame = micros();
+                display_flush();
+            }
         }
+        display_flush();
+        unsigned long elapsed = micros() - start;
+
+        Serial.printf("\n[DISPLAY %s: %d chars in %lu ms, %lu chars/s]\n",
+                      useAtlas ? "atlas+DMA" : "drawChar", total, elapsed / 1000,
+                      (unsigned long)((uint64_t)total * 1000000 / elapsed));
     }
-    else
+
+    useAtlas = true;
+    display_clear();
+}
+
+void display_get_state(uint8_t *state)
+{
+    for (int row = 0; row < DISPLAY_ROWS; row++)
     {
-        // Store character in buffer and print it
-        screenBuffer[currentRow][currentCol] = c;
-        tft.print(c);
-        currentCol++;
+        memcpy(state + row * DISPLAY_COLS, screen_line(shown, row), DISPLAY_COLS);
     }
+    state[DISPLAY_ROWS * DISPLAY_COLS] = shown->currentRow;
+    state[DISPLAY_ROWS * DISPLAY_COLS + 1] = shown->currentCol;
+}
+
+void display_set_state(const uint8_t *state)
+{
+    shown->topLine = 0;
+    for (int row = 0; row < DISPLAY_ROWS; row++)
+    {
+        memcpy(shown->screenBuffer[row], state + row * DISPLAY_COLS, DISPLAY_COLS);
+    }
+    shown->currentRow = state[DISPLAY_ROWS * DISPLAY_COLS] % DISPLAY_ROWS;
+    shown->currentCol = state[DISPLAY_ROWS * DISPLAY_COLS + 1] % (DISPLAY_COLS + 1);
+    cursorVisible = false;
+    mark_all_dirty();
 }
 
 void display_write(const char *str)
@@ -195,27 +466,23 @@ void display_update_cursor()
 {
     unsigned long currentTime = millis();
 
-    // Blink cursor every 500ms
+    // Blink cursor every 500ms; drawn by the next frame
     if (currentTime - lastCursorBlink >= 500)
     {
         lastCursorBlink = currentTime;
         cursorVisible = !cursorVisible;
+        rowDirty[shown->currentRow] = true;
+    }
+}
 
-        const int charWidth = 6; // Font 1 is fixed 6 pixels wide
-        int x = currentCol * charWidth;
-        int y = currentRow * LINE_HEIGHT;
-
-        if (cursorVisible)
-        {
-            tft.setCursor(x, y);
-            tft.print('@');
-        }
-        else
-        {
-            tft.fillRect(x, y, charWidth, LINE_HEIGHT, TFT_BLACK);
-        }
+void display_update()
+{
+    display_update_cursor();
 
-        // Always restore TFT cursor to current write position
-        tft.setCursor(currentCol * charWidth, currentRow * LINE_HEIGHT);
+    unsigned long now = millis();
+    if (now - lastFrame >= 1000 / DISPLAY_FPS)
+    {
+        lastFrame = now;
+        display_flush();
     }
-}
\ No newline at end of file
+}
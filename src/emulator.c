@@ -1,34 +1,169 @@
 #include "emulator.h"
-#include "display.h"
 #include "wozmon_rom.h"
 #include "basic_rom.h"
-#include "cellular_rom.h"
+#include "debugger.h"
+#include "library.h"
+#include "profile.h"
+#include "trace.h"
+#include "spsc_queue.h"
 #include <stdio.h>
 #include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
 
 // Apple-1 Memory Map
 #define KBD 0xD010   // Keyboard data register
 #define KBDCR 0xD011 // Keyboard control register
 #define DSP 0xD012   // Display data register
 #define DSPCR 0xD013 // Display control register
+#define IO_PAGE 0xD0 // Page holding the PIA registers
 
-#define RAM_SIZE 0x2000     // 8KB RAM (0x0000-0x1FFF)
-#define CELLULAR_START 0x0300 // Cellular program loads at $0300
-#define BASIC_START 0xE000  // BASIC loads at $E000
+// RAM from $0000, in KB (build with -DRAM_KB=4/8/16/32)
+#ifndef RAM_KB
+#define RAM_KB 8
+#endif
+#if RAM_KB != 4 && RAM_KB != 8 && RAM_KB != 16 && RAM_KB != 32
+#error "RAM_KB must be 4, 8, 16 or 32"
+#endif
+
+#define RAM_SIZE (RAM_KB * 1024) // RAM at $0000-(RAM_SIZE-1)
+#define BASIC_START 0xE000  // BASIC ROM at $E000
+#define BASIC_SIZE 4096     // 4KB
 #define ROM_START 0xFF00    // ROM starts at 0xFF00
 #define ROM_SIZE 256        // 256 bytes
 #define RESET_VECTOR 0xFFFC // Reset vector location
+#define OPEN_BUS 0xFF       // Value read from unmapped addresses
 
-uint8_t memory[65536];
+// Build with -DEMULATOR_DIAGNOSTICS to have setup_emulator() dump the start
+// of Wozmon and check the reset vector
 
-// Keyboard input buffer
-static uint8_t kbd_data = 0;
-static uint8_t kbd_strobe = 0; // Separate strobe flag
-static char last_char = 0; // To prevent duplicate chars
+// Wozmon entry points run natively (build with -DWOZMON_TRAPS=0 to
+// interpret them). -DWOZMON_TRAPS_VERIFY checks every trap against the ROM
+// code on the host.
+#ifndef WOZMON_TRAPS
+#define WOZMON_TRAPS 1
+#endif
+#define WOZ_IN 0x0200       // Wozmon's line buffer
+#define WOZ_NEXTCHAR 0xFF29 // Key wait at the heart of GETLINE
+#define WOZ_ECHO 0xFFEF     // Print the character in A
+#define WOZ_BS 0xDF         // GETLINE's backspace, escape and return keys
+#define WOZ_ESC 0x9B
+#define WOZ_CR 0x8D
+#define WOZ_PROMPT 0xDC     // "\", printed on reset
 
-// Queue a character from keyboard (serial input)
-void emulator_queue_key(char c)
+// Keys typed but not yet latched into KBD; big enough to take a pasted
+// program while the serial side holds the sender off with XOFF
+#ifndef KEY_QUEUE_SIZE
+#define KEY_QUEUE_SIZE 1024
+#endif
+// Characters written to DSP but not yet displayed. While it is full the
+// display reports busy (DSP bit 7), as the Apple-1's terminal section does.
+#ifndef DSP_QUEUE_SIZE
+#define DSP_QUEUE_SIZE 64
+#endif
+
+#define RAM_PAGES (RAM_SIZE >> 8)
+
+struct apple1
+{
+    // First, so the fields every instruction touches start the allocation
+    cpu6502_t cpu;
+
+    uint8_t memory[RAM_SIZE];
+
+    // RAM pages that may differ from their power-on contents, one bit each.
+    // A clean page is mapped for reads only, so its first write goes
+    // through bus_write(), which marks it and maps it in place; after that,
+    // tracking costs nothing. A reset then only has to clear the pages
+    // marked.
+    uint8_t dirty_pages[RAM_PAGES / 8];
+    uint8_t boot_pages[RAM_PAGES / 8]; // Hold the library's boot programs
+    uint8_t ram_ready;                 // setup_emulator() has run
+
+    // Cycles since the last reset, until Wozmon prints its prompt
+    uint32_t reset_cycles;
+    uint8_t prompt_seen;
+
+    // Keyboard input buffer
+    uint8_t kbd_data;
+    uint8_t kbd_strobe; // Separate strobe flag
+    char last_char;     // To prevent duplicate chars
+    uint8_t kbd_poll;   // 6502 polled the keyboard with no key ready
+    uint8_t kbd_wait;   // ...and it was a loop waiting for one
+
+    // Keys flow in and display output flows out through lock-free queues,
+    // so the serial/display side can run on another core from the 6502
+    uint8_t key_storage[KEY_QUEUE_SIZE];
+    spsc_queue_t key_queue;
+    uint32_t key_high_water; // Updated by the producer
+    uint32_t key_overflows;
+    uint8_t dsp_storage[DSP_QUEUE_SIZE];
+    spsc_queue_t dsp_queue;
+
+    // Text typed by emulator_type_headless() in place of the key queue,
+    // with display output going to feed_output instead of the display
+    const char *feed_next;
+    const char *feed_end;
+    char feed_last;
+    void (*feed_output)(void *context, char c);
+    void *feed_context;
+
+    // check_stuck()
+    uint16_t stuck_pc;
+    uint8_t stuck_reported;
+
+    // Writes to ROM and unmapped pages land here and are never read back
+    uint8_t write_sink[256];
+
+#ifdef FAKE6502_DEBUG
+    // Watched pages are unmapped; what they were mapped to is kept here
+    uint8_t watched[256];
+    const uint8_t *home_read[256];
+#endif
+};
+
+// Unmapped pages read from here; the ROMs are mapped straight from the
+// const arrays, so they stay in flash on the ESP32 and all machines share
+// them
+static const uint8_t open_bus[256] = {[0 ... 255] = OPEN_BUS};
+
+static uint8_t bus_read(void *context, uint16_t address);
+static void bus_write(void *context, uint16_t address, uint8_t value);
+
+apple1_t *emulator_create()
+{
+    // Aligned like the cpu6502_t it starts with
+#ifdef ESP_PLATFORM
+    apple1_t *m = heap_caps_aligned_alloc(_Alignof(apple1_t), sizeof(apple1_t), MALLOC_CAP_8BIT);
+#else
+    apple1_t *m = aligned_alloc(_Alignof(apple1_t), sizeof(apple1_t));
+#endif
+    if (!m)
+    {
+        return NULL;
+    }
+    memset(m, 0, sizeof(*m));
+    init6502(&m->cpu, bus_read, bus_write, m);
+    m->key_queue = (spsc_queue_t)SPSC_QUEUE_INIT(m->key_storage);
+    m->dsp_queue = (spsc_queue_t)SPSC_QUEUE_INIT(m->dsp_storage);
+    return m;
+}
+
+void emulator_destroy(apple1_t *m)
+{
+    free(m);
+}
+
+cpu6502_t *emulator_cpu(apple1_t *m)
+{
+    return &m->cpu;
+}
+
+// The key the Apple-1 keyboard sends for a typed character
+static char apple_key(char c)
 {
     // Convert lowercase to uppercase (Apple-1 style)
     if (c >= 'a' && c <= 'z')
@@ -41,66 +176,196 @@ void emulator_queue_key(char c)
     {
         c = '\r'; // 0x0D
     }
+    return c;
+}
+
+// Queue a character from keyboard (serial input)
+int emulator_queue_key(apple1_t *m, char c)
+{
+    c = apple_key(c);
 
     // Ignore duplicate CR characters (happens when terminal sends both \r and \n)
-    if (c == '\r' && last_char == '\r')
+    if (c == '\r' && m->last_char == '\r')
     {
-        return;
+        return 1;
+    }
+
+    // Queue it; the strobe is set once the 6502 gets to it
+    if (!spsc_push(&m->key_queue, c))
+    {
+        m->key_overflows++;
+        return 0;
     }
-    last_char = c;
+    m->last_char = c;
 
-    // Store character and set strobe
-    kbd_data = c;
-    kbd_strobe = 1;
+    uint32_t queued = spsc_count(&m->key_queue);
+    if (queued > m->key_high_water)
+    {
+        m->key_high_water = queued;
+    }
+    return 1;
 }
 
-// These functions are required by fake6502
-uint8_t read6502(uint16_t address)
+void emulator_get_keyboard(apple1_t *m, keyboard_state_t *state)
 {
-    static uint32_t dsp_read_count = 0;
-    
-    // Handle memory-mapped I/O
+    state->kbd_data = m->kbd_data;
+    state->kbd_strobe = m->kbd_strobe;
+    state->last_char = m->last_char;
+}
+
+void emulator_set_keyboard(apple1_t *m, const keyboard_state_t *state)
+{
+    m->kbd_data = state->kbd_data;
+    m->kbd_strobe = state->kbd_strobe;
+    m->last_char = state->last_char;
+    m->kbd_poll = 0;
+    m->kbd_wait = 0;
+    spsc_clear(&m->key_queue);
+    spsc_clear(&m->dsp_queue);
+}
+
+uint32_t emulator_key_queue_free(apple1_t *m)
+{
+    return spsc_free(&m->key_queue);
+}
+
+void emulator_get_key_stats(apple1_t *m, key_queue_stats_t *stats)
+{
+    stats->queued = spsc_count(&m->key_queue);
+    stats->capacity = KEY_QUEUE_SIZE;
+    stats->high_water = m->key_high_water;
+    stats->overflows = m->key_overflows;
+}
+
+int emulator_read_output(apple1_t *m, char *c)
+{
+    return spsc_pop(&m->dsp_queue, (uint8_t *)c);
+}
+
+// Next key of the headless text, with the same CR handling as
+// emulator_queue_key(). Returns 0 once it is used up.
+static int feed_key(apple1_t *m, uint8_t *key)
+{
+    while (m->feed_next < m->feed_end)
+    {
+        char c = apple_key(*m->feed_next++);
+        if (c == '\r' && m->feed_last == '\r')
+        {
+            continue;
+        }
+        m->feed_last = c;
+        *key = c;
+        return 1;
+    }
+    return 0;
+}
+
+// Move the next queued key into KBD once the previous one has been read
+static void latch_key(apple1_t *m)
+{
+    if (m->kbd_strobe)
+    {
+        return;
+    }
+    if (m->feed_output ? feed_key(m, &m->kbd_data) : spsc_pop(&m->key_queue, &m->kbd_data))
+    {
+        m->kbd_strobe = 1;
+    }
+}
+
+// Memory-mapped I/O page ($D000-$D0FF). Only the four PIA registers are
+// decoded, the rest of the page is open bus.
+static uint8_t io_read(apple1_t *m, uint16_t address)
+{
+#ifdef FAKE6502_PROFILE
+    profile_io(&m->cpu, address, 0);
+#endif
     switch (address)
     {
     case KBD: // Keyboard data - return with high bit set if strobe is active
     {
-        uint8_t value = kbd_data | (kbd_strobe ? 0x80 : 0x00);
-        kbd_strobe = 0; // Clear strobe after reading KBD
-        kbd_data = 0;   // Clear data to prevent re-reading stale characters
+        latch_key(m);
+        if (!m->kbd_strobe)
+        {
+            m->kbd_poll = 1;
+            stop6502(&m->cpu);
+        }
+        uint8_t value = m->kbd_data | (m->kbd_strobe ? 0x80 : 0x00);
+        m->kbd_strobe = 0; // Clear strobe after reading KBD
+        m->kbd_data = 0;   // Clear data to prevent re-reading stale characters
         return value;
     }
 
     case KBDCR: // Keyboard control - just return status, don't clear strobe
     {
+        latch_key(m);
+
         // Return high bit set only if strobe is active
         // This is critical: kbd_data might have bit 7 set, but we only
         // want to indicate "key ready" when strobe is active
-        uint8_t status = kbd_strobe ? 0x80 : 0x00;
+        uint8_t status = m->kbd_strobe ? 0x80 : 0x00;
+        if (!m->kbd_strobe)
+        {
+            // Nothing to read, end the run6502() batch so run_emulator()
+            // can check for a key-wait loop
+            m->kbd_poll = 1;
+            stop6502(&m->cpu);
+        }
         return status;
     }
 
-    case DSP: // Display data - reads undefined, return 0
+    case DSP: // Display data - bit 7 (PB7) is the display's busy line
+        if (!m->feed_output && spsc_free(&m->dsp_queue) == 0)
+        {
+            // ECHO spins on BIT DSP / BMI until the display takes a
+            // character; end the batch rather than emulate the spin
+            stop6502(&m->cpu);
+            return 0x80;
+        }
         return 0x00;
 
     case DSPCR: // Display control - return ready status
         return 0x00; // Bit 7 clear = ready (opposite of keyboard!)
 
     default:
-        return memory[address];
+        return OPEN_BUS;
     }
 }
 
-void write6502(uint16_t address, uint8_t value)
+static void io_write(apple1_t *m, uint16_t address, uint8_t value)
 {
-    // Handle memory-mapped I/O
+#ifdef FAKE6502_PROFILE
+    profile_io(&m->cpu, address, 1);
+#endif
     switch (address)
     {
     case DSP: // Display output
     {
         char c = value & 0x7F; // Strip high bit
 
-        // Output to display (display will handle CR conversion)
-        display_write_char(c);
+        // End the batch on the first prompt after a reset, so the cycles
+        // it took are counted exactly
+        if (!m->prompt_seen && (value | 0x80) == WOZ_PROMPT)
+        {
+            m->prompt_seen = 1;
+            stop6502(&m->cpu);
+        }
+
+        if (m->feed_output)
+        {
+            m->feed_output(m->feed_context, c);
+            break;
+        }
+
+        // Queue for the display (display will handle CR conversion). Once
+        // that fills the queue, end the run6502() batch: run_emulator() only
+        // starts one with room, so a program that ignores the busy bit is
+        // held back too.
+        spsc_push(&m->dsp_queue, c);
+        if (spsc_free(&m->dsp_queue) == 0)
+        {
+            stop6502(&m->cpu);
+        }
         break;
     }
 
@@ -112,101 +377,677 @@ void write6502(uint16_t address, uint8_t value)
         break;
 
     default:
-        // Protect ROM area from writes
-        if (address < ROM_START)
-        {
-            memory[address] = value;
-        }
         break;
     }
 }
 
-void setup_emulator()
+// ---- Wozmon traps ----
+
+#if WOZMON_TRAPS
+static void set_flags(cpu6502_t *cpu, uint8_t mask, uint8_t value)
+{
+    setP(cpu, (getP(cpu) & ~mask) | value);
+}
+
+static uint16_t pull_return(apple1_t *m)
 {
-    // Clear all memory including ROM area
-    for (uint32_t i = 0; i < 65536; i++)
+    uint16_t lo = bus_read(m, 0x0100 + (uint8_t)(m->cpu.sp + 1));
+    uint16_t hi = bus_read(m, 0x0100 + (uint8_t)(m->cpu.sp + 2));
+    m->cpu.sp += 2;
+    return (hi << 8 | lo) + 1;
+}
+
+// ECHO: BIT DSP / BMI ECHO / STA DSP / RTS. Left to the ROM while the
+// display is busy, so the spin and its early exit happen as before.
+static uint32_t woz_echo(cpu6502_t *cpu)
+{
+    apple1_t *m = cpu->context;
+    if (spsc_free(&m->dsp_queue) == 0)
     {
-        memory[i] = 0;
+        return 0;
     }
 
-    // Load Wozmon ROM from embedded data
-    size_t copy_size = (wozmon_rom_len < ROM_SIZE) ? wozmon_rom_len : ROM_SIZE;
-    memcpy(&memory[ROM_START], wozmon_rom, copy_size);
-    
-    printf("Wozmon loaded from embedded ROM (%u bytes)\n", copy_size);
-    
-    // Load Apple-1 BASIC into RAM at $E000
-    size_t basic_size = (basic_rom_len < 4096) ? basic_rom_len : 4096;
-    memcpy(&memory[BASIC_START], basic_rom, basic_size);
-    
-    printf("Apple-1 BASIC loaded at $E000 (%u bytes)\n", basic_size);
-    printf("To run BASIC, type: E000R\n");
-    
-    // Load Cellular Automaton program at $0300
-    memcpy(&memory[CELLULAR_START], cellular_rom, cellular_rom_len);
-    
-    printf("Cellular Automaton loaded at $0300 (%u bytes)\n", cellular_rom_len);
-    printf("To run Cellular, type: 300R\n");
-    
-    // Dump ROM sections for debugging
+    io_write(m, DSP, cpu->a);
+    set_flags(cpu, 0xC2, 0x02); // BIT of a ready DSP: N=0, V=0, Z=1
+    cpu->pc = pull_return(m);
+    return 4 + 2 + 4 + 6;
+}
+
+// NEXTCHAR with a key waiting: read it, store it at IN,Y, echo it and
+// advance Y, ending back at NEXTCHAR. Return, backspace and escape, a full
+// line and a busy display go through the ROM.
+static uint32_t woz_nextchar(cpu6502_t *cpu)
+{
+    apple1_t *m = cpu->context;
+    uint8_t key;
+    if (m->feed_output)
+    {
+        return 0;
+    }
+    else if (m->kbd_strobe)
+    {
+        key = m->kbd_data;
+    }
+    else if (spsc_count(&m->key_queue) > 0)
+    {
+        key = m->key_storage[m->key_queue.tail & m->key_queue.mask];
+    }
+    else
+    {
+        return 0; // LDA KBDCR ends the batch on its own
+    }
+
+    key |= 0x80;
+    if (key == WOZ_CR || key == WOZ_BS || key == WOZ_ESC ||
+        (uint8_t)(cpu->y + 1) & 0x80 || spsc_free(&m->dsp_queue) == 0)
+    {
+        return 0;
+    }
+
+    io_read(m, KBDCR);          // LDA KBDCR / BPL NEXTCHAR
+    cpu->a = io_read(m, KBD);   // LDA KBD
+    bus_write(m, WOZ_IN + cpu->y, cpu->a);
+    bus_write(m, 0x0100 + cpu->sp, 0xFF);                // JSR ECHO leaves its
+    bus_write(m, 0x0100 + (uint8_t)(cpu->sp - 1), 0x36); // return address behind
+    io_write(m, DSP, cpu->a);   // ECHO
+    cpu->y++;                   // CMP #CR / BNE NOTCR / CMP #BS / CMP #ESC / INY
+    set_flags(cpu, 0xC3, (cpu->a >= WOZ_ESC ? 0x01 : 0) | (cpu->y == 0 ? 0x02 : 0));
+    cpu->pc = WOZ_NEXTCHAR;     // BPL NEXTCHAR
+    return 4 + 2 + 4 + 5 + 6 + 16 + 2 + 3 + 2 + 2 + 2 + 2 + 2 + 3;
+}
+
+#ifdef WOZMON_TRAPS_VERIFY
+#ifdef FAKE6502_TABLE_DISPATCH
+#define step_rom step6502_tables
+#else
+#define step_rom step6502_fused
+#endif
+
+// Everything a trap may touch
+typedef struct
+{
+    uint16_t pc;
+    uint8_t sp, a, x, y, p;
+    uint8_t memory[RAM_SIZE];
+    uint8_t kbd_data, kbd_strobe, kbd_poll;
+    spsc_queue_t key_queue, dsp_queue;
+    uint8_t key_storage[KEY_QUEUE_SIZE];
+    uint8_t dsp_storage[DSP_QUEUE_SIZE];
+} machine_state_t;
+
+static void save_state(const apple1_t *m, machine_state_t *st)
+{
+    const cpu6502_t *cpu = &m->cpu;
+    st->pc = cpu->pc, st->sp = cpu->sp, st->a = cpu->a, st->x = cpu->x, st->y = cpu->y;
+    st->p = getP(cpu);
+    memcpy(st->memory, m->memory, sizeof(m->memory));
+    st->kbd_data = m->kbd_data, st->kbd_strobe = m->kbd_strobe, st->kbd_poll = m->kbd_poll;
+    st->key_queue = m->key_queue, st->dsp_queue = m->dsp_queue;
+    memcpy(st->key_storage, m->key_storage, sizeof(m->key_storage));
+    memcpy(st->dsp_storage, m->dsp_storage, sizeof(m->dsp_storage));
+}
+
+static void load_state(apple1_t *m, const machine_state_t *st)
+{
+    cpu6502_t *cpu = &m->cpu;
+    cpu->pc = st->pc, cpu->sp = st->sp, cpu->a = st->a, cpu->x = st->x, cpu->y = st->y;
+    setP(cpu, st->p);
+    memcpy(m->memory, st->memory, sizeof(m->memory));
+    m->kbd_data = st->kbd_data, m->kbd_strobe = st->kbd_strobe, m->kbd_poll = st->kbd_poll;
+    m->key_queue.head = st->key_queue.head, m->key_queue.tail = st->key_queue.tail;
+    m->dsp_queue.head = st->dsp_queue.head, m->dsp_queue.tail = st->dsp_queue.tail;
+    memcpy(m->key_storage, st->key_storage, sizeof(m->key_storage));
+    memcpy(m->dsp_storage, st->dsp_storage, sizeof(m->dsp_storage));
+}
+
+static int same_state(const machine_state_t *a, const machine_state_t *b)
+{
+    return a->pc == b->pc && a->sp == b->sp && a->a == b->a && a->x == b->x &&
+           a->y == b->y && a->p == b->p &&
+           memcmp(a->memory, b->memory, sizeof(a->memory)) == 0 &&
+           a->kbd_data == b->kbd_data && a->kbd_strobe == b->kbd_strobe &&
+           a->kbd_poll == b->kbd_poll &&
+           a->key_queue.head == b->key_queue.head && a->key_queue.tail == b->key_queue.tail &&
+           a->dsp_queue.head == b->dsp_queue.head && a->dsp_queue.tail == b->dsp_queue.tail &&
+           memcmp(a->key_storage, b->key_storage, sizeof(a->key_storage)) == 0 &&
+           memcmp(a->dsp_storage, b->dsp_storage, sizeof(a->dsp_storage)) == 0;
+}
+
+// Run the trap, then the ROM code from the same state up to where the trap
+// left off, and abort if the two disagree. The states are big, so they are
+// allocated rather than kept per machine or on the stack.
+static uint32_t verify_trap(cpu6502_t *cpu, trap6502_t trap, const char *name)
+{
+    apple1_t *m = cpu->context;
+    machine_state_t *before = malloc(3 * sizeof(machine_state_t));
+    if (!before)
+    {
+        printf("Trap %s: no memory to verify it\n", name);
+        abort();
+    }
+    machine_state_t *native = before + 1, *rom = before + 2;
+
+    save_state(m, before);
+    uint32_t native_cycles = trap(cpu);
+    if (native_cycles == 0)
+    {
+        free(before);
+        return 0;
+    }
+    save_state(m, native);
+
+    load_state(m, before);
+    uint32_t rom_cycles = 0;
+    int steps = 0;
+    do
+    {
+        rom_cycles += step_rom(cpu);
+    } while (++steps < 1000 && (cpu->pc != native->pc || cpu->sp != native->sp));
+    save_state(m, rom);
+
+    if (rom_cycles != native_cycles || !same_state(rom, native))
+    {
+        printf("Trap %s at $%04X differs from ROM: cycles %u/%u, PC %04X/%04X, "
+               "A %02X/%02X, X %02X/%02X, Y %02X/%02X, SP %02X/%02X, P %02X/%02X\n",
+               name, before->pc, (unsigned)native_cycles, (unsigned)rom_cycles,
+               native->pc, rom->pc, native->a, rom->a, native->x, rom->x, native->y, rom->y,
+               native->sp, rom->sp, native->p, rom->p);
+        fflush(stdout);
+        abort();
+    }
+    free(before);
+    return native_cycles;
+}
+
+static uint32_t verify_echo(cpu6502_t *cpu)
+{
+    return verify_trap(cpu, woz_echo, "ECHO");
+}
+
+static uint32_t verify_nextchar(cpu6502_t *cpu)
+{
+    return verify_trap(cpu, woz_nextchar, "NEXTCHAR");
+}
+#endif
+
+#endif // WOZMON_TRAPS
+
+static void install_traps(apple1_t *m)
+{
+#if !WOZMON_TRAPS
+    trap6502(&m->cpu, WOZ_ECHO, NULL);
+    trap6502(&m->cpu, WOZ_NEXTCHAR, NULL);
+#elif defined(WOZMON_TRAPS_VERIFY)
+    trap6502(&m->cpu, WOZ_ECHO, verify_echo);
+    trap6502(&m->cpu, WOZ_NEXTCHAR, verify_nextchar);
+#else
+    trap6502(&m->cpu, WOZ_ECHO, woz_echo);
+    trap6502(&m->cpu, WOZ_NEXTCHAR, woz_nextchar);
+#endif
+}
+
+static void map_rom(apple1_t *m, uint16_t start, const uint8_t *rom, size_t len)
+{
+    for (size_t offset = 0; offset < len; offset += 256)
+    {
+        m->cpu.read_pages[(start + offset) >> 8] = rom + offset;
+    }
+}
+
+static void map_pages(apple1_t *m)
+{
+    for (int page = 0; page < 256; page++)
+    {
+        m->cpu.read_pages[page] = open_bus;
+        m->cpu.write_pages[page] = m->write_sink;
+    }
+
+    for (int page = 0; page < RAM_PAGES; page++)
+    {
+        m->cpu.read_pages[page] = &m->memory[page << 8];
+        m->cpu.write_pages[page] = &m->memory[page << 8];
+    }
+
+    // Only the I/O page goes through io_read()/io_write()
+    m->cpu.read_pages[IO_PAGE] = NULL;
+    m->cpu.write_pages[IO_PAGE] = NULL;
+
+    map_rom(m, BASIC_START, basic_rom, BASIC_SIZE);
+    map_rom(m, ROM_START, wozmon_rom, ROM_SIZE);
+}
+
+#ifdef FAKE6502_DEBUG
+static uint8_t *home_write(apple1_t *m, uint8_t page)
+{
+    if (page < RAM_PAGES)
+    {
+        return m->dirty_pages[page >> 3] & (1 << (page & 7)) ? &m->memory[page << 8] : NULL;
+    }
+    return page == IO_PAGE ? NULL : m->write_sink;
+}
+
+void emulator_watch_page(apple1_t *m, uint8_t page, uint8_t flags)
+{
+    if (!m->watched[page])
+    {
+        m->home_read[page] = m->cpu.read_pages[page];
+    }
+    m->watched[page] = flags;
+    m->cpu.read_pages[page] = flags & WATCH_READ ? NULL : m->home_read[page];
+    m->cpu.write_pages[page] = flags & WATCH_WRITE ? NULL : home_write(m, page);
+}
+#endif
+
+// The 6502's bus callbacks, for the pages the page map leaves NULL. The
+// traps call them for any page.
+static uint8_t bus_read(void *context, uint16_t address)
+{
+    apple1_t *m = context;
+    const uint8_t *page = m->cpu.read_pages[address >> 8];
+    if (page)
+    {
+        return page[address & 0xFF];
+    }
+#ifdef FAKE6502_DEBUG
+    if (m->watched[address >> 8] & WATCH_READ)
+    {
+        page = m->home_read[address >> 8];
+        uint8_t value = page ? page[address & 0xFF] : io_read(m, address);
+        debugger_access(m, address, value, 0);
+        return value;
+    }
+#endif
+    return io_read(m, address);
+}
+
+static void mark_dirty(apple1_t *m, uint8_t page)
+{
+    m->dirty_pages[page >> 3] |= 1 << (page & 7);
+#ifdef FAKE6502_DEBUG
+    if (m->watched[page] & WATCH_WRITE)
+    {
+        return;
+    }
+#endif
+    m->cpu.write_pages[page] = &m->memory[page << 8];
+}
+
+// Mark all of RAM clean, with writes to it going through bus_write() again
+static void mark_clean(apple1_t *m)
+{
+    memset(m->dirty_pages, 0, sizeof(m->dirty_pages));
+    for (int page = 0; page < RAM_PAGES; page++)
+    {
+        m->cpu.write_pages[page] = NULL;
+    }
+}
+
+static void bus_write(void *context, uint16_t address, uint8_t value)
+{
+    apple1_t *m = context;
+    uint8_t *page = m->cpu.write_pages[address >> 8];
+    if (page)
+    {
+        page[address & 0xFF] = value;
+        return;
+    }
+#ifdef FAKE6502_DEBUG
+    if (m->watched[address >> 8] & WATCH_WRITE)
+    {
+        debugger_access(m, address, value, 1);
+    }
+#endif
+    if (address < RAM_SIZE)
+    {
+        mark_dirty(m, address >> 8);
+        m->memory[address] = value;
+        return;
+    }
+    io_write(m, address, value);
+}
+
+// Debugger-style access: no I/O side effects, writes only land in RAM
+uint8_t read_memory(apple1_t *m, uint16_t address)
+{
+    const uint8_t *page = m->cpu.read_pages[address >> 8];
+#ifdef FAKE6502_DEBUG
+    if (!page)
+    {
+        page = m->home_read[address >> 8];
+    }
+#endif
+    return page ? page[address & 0xFF] : OPEN_BUS;
+}
+
+void write_memory(apple1_t *m, uint16_t address, uint8_t value)
+{
+    if (address < RAM_SIZE)
+    {
+        mark_dirty(m, address >> 8);
+        m->memory[address] = value;
+    }
+}
+
+uint32_t emulator_ram_size()
+{
+    return RAM_SIZE;
+}
+
+int emulator_load(apple1_t *m, uint16_t address, const uint8_t *data, uint32_t len)
+{
+    if ((uint32_t)address + len > RAM_SIZE)
+    {
+        return 0;
+    }
+    memcpy(&m->memory[address], data, len);
+    for (uint32_t page = address >> 8; len && page <= (address + len - 1) >> 8; page++)
+    {
+        mark_dirty(m, page);
+    }
+    return 1;
+}
+
+void emulator_run_from(apple1_t *m, uint16_t address)
+{
+    m->cpu.pc = address;
+    m->kbd_wait = 0;
+}
+
+static void reset_keyboard(apple1_t *m)
+{
+    m->kbd_data = 0;
+    m->kbd_strobe = 0;
+    spsc_clear(&m->key_queue);
+}
+
+#ifdef EMULATOR_DIAGNOSTICS
+static void print_diagnostics(apple1_t *m)
+{
     printf("ROM $FF00-$FF0F: ");
-    for (int i = 0; i < 16; i++) {
-        printf("%02X ", memory[ROM_START + i]);
+    for (int i = 0; i < 16; i++)
+    {
+        printf("%02X ", read_memory(m, ROM_START + i));
     }
     printf("\n");
-    
+
     printf("ROM $FF40-$FF4F: ");
-    for (int i = 0x40; i < 0x50; i++) {
-        printf("%02X ", memory[ROM_START + i]);
+    for (int i = 0x40; i < 0x50; i++)
+    {
+        printf("%02X ", read_memory(m, ROM_START + i));
     }
     printf("\n");
 
-    // Check reset vector
-    printf("Reset vector at $FFFC: %02X%02X (points to $%02X%02X)\n", 
-           memory[RESET_VECTOR+1], memory[RESET_VECTOR],
-           memory[RESET_VECTOR+1], memory[RESET_VECTOR]);
-    
-    // Always ensure reset vector points to ROM_START
-    if (memory[RESET_VECTOR] != 0x00 || memory[RESET_VECTOR+1] != 0xFF)
+    printf("Reset vector at $FFFC: %02X%02X (points to $%02X%02X)\n",
+           read_memory(m, RESET_VECTOR + 1), read_memory(m, RESET_VECTOR),
+           read_memory(m, RESET_VECTOR + 1), read_memory(m, RESET_VECTOR));
+
+    // The ROM is read-only, so a bad vector can only be reported
+    if (read_memory(m, RESET_VECTOR) != 0x00 || read_memory(m, RESET_VECTOR + 1) != 0xFF)
     {
-        printf("Reset vector incorrect, fixing to point to $FF00\n");
-        memory[RESET_VECTOR] = 0x00;     // Low byte
-        memory[RESET_VECTOR + 1] = 0xFF; // High byte  
+        printf("Reset vector incorrect, expected $FF00\n");
     }
-
-    // Initialize keyboard
-    kbd_data = 0;
-    kbd_strobe = 0;
 }
+#endif
 
-void reset_emulator()
+void setup_emulator(apple1_t *m)
 {
-    setup_emulator();
-    reset6502();
+    // Clear RAM; the ROMs are mapped in place, not copied, and writes to
+    // them are dropped
+    memset(m->memory, 0, sizeof(m->memory));
+    map_pages(m);
+
+    printf("Wozmon mapped from embedded ROM at $FF00 (%u bytes)\n", wozmon_rom_len);
+    printf("Apple-1 BASIC mapped at $E000 (%u bytes)\n", basic_rom_len);
+    printf("To run BASIC, type: E000R\n");
+
+    // Programs the library preloads (Cellular at $0300). The pages they
+    // land on are noted, so a reset knows to reload them if they are
+    // written to.
+    memset(m->dirty_pages, 0, sizeof(m->dirty_pages));
+    library_load_boot(m, 1);
+    memcpy(m->boot_pages, m->dirty_pages, sizeof(m->boot_pages));
+    mark_clean(m);
+
+#ifdef EMULATOR_DIAGNOSTICS
+    print_diagnostics(m);
+#endif
+#ifdef FAKE6502_PROFILE
+    profile_clear(m);
+#endif
+#ifdef FAKE6502_TRACE
+    trace_clear(m);
+#endif
+
+    reset_keyboard(m);
+    install_traps(m);
+    m->ram_ready = 1;
 }
 
-void step_emulator()
+// Put RAM back to its power-on contents, touching only the pages written
+// since
+static void clear_dirty_ram(apple1_t *m)
 {
-    static uint16_t last_pc = 0;
-    static uint32_t stuck_count = 0;
-    
-    step6502();
-    
-    // Detect if CPU is stuck in a loop
-    if (PC == last_pc)
+    int reload = 0;
+    for (int page = 0; page < RAM_PAGES; page++)
     {
-        stuck_count++;
-        if (stuck_count == 50000)
+        uint8_t bit = 1 << (page & 7);
+        if (m->dirty_pages[page >> 3] & bit)
         {
-            printf("CPU stuck at PC=%04X A=%02X X=%02X Y=%02X SP=%02X\n", PC, A, X, Y, SP);
-            printf("Memory at PC: %02X %02X %02X\n", memory[PC], memory[PC+1], memory[PC+2]);
-            stuck_count = 0;
+            memset(&m->memory[page << 8], 0, 256);
+            reload |= m->boot_pages[page >> 3] & bit;
         }
     }
+    if (reload)
+    {
+        library_load_boot(m, 0);
+    }
+    mark_clean(m);
+}
+
+void emulator_print_memory_report()
+{
+    printf("Memory map: RAM $0000-$%04X (%u KB), I/O $D000-$D0FF, "
+           "BASIC $E000-$EFFF, Wozmon $FF00-$FFFF, open bus elsewhere\n",
+           RAM_SIZE - 1, RAM_KB);
+    printf("Emulator DRAM: %u bytes per machine (%u RAM, %u 6502 with its page map, "
+           "%u key and display queues)\n",
+           (unsigned)sizeof(apple1_t), RAM_SIZE, (unsigned)sizeof(cpu6502_t),
+           KEY_QUEUE_SIZE + DSP_QUEUE_SIZE);
+    printf("ROMs in flash: %u bytes, software library %u bytes\n",
+           wozmon_rom_len + basic_rom_len, (unsigned)library_flash_size());
+}
+
+void reset_emulator(apple1_t *m)
+{
+    if (m->ram_ready)
+    {
+        clear_dirty_ram(m);
+        reset_keyboard(m);
+    }
     else
     {
-        stuck_count = 0;
+        setup_emulator(m);
+    }
+    reset6502(&m->cpu);
+    m->reset_cycles = 0;
+    m->prompt_seen = 0;
+}
+
+uint32_t emulator_cycles_to_prompt(apple1_t *m)
+{
+    return m->prompt_seen ? m->reset_cycles : 0;
+}
+
+uint32_t emulator_dirty_pages(apple1_t *m)
+{
+    uint32_t n = 0;
+    for (int page = 0; page < RAM_PAGES; page++)
+    {
+        n += (m->dirty_pages[page >> 3] >> (page & 7)) & 1;
+    }
+    return n;
+}
+
+// After an empty keyboard poll, PC is at the instruction following it. A
+// branch from there back to the poll, or just before it, is a loop doing
+// nothing but wait for a key (Wozmon, BASIC's RDKEY, most programs). A poll
+// that carries on, like BASIC checking for a break key between statements,
+// isn't.
+static int in_key_wait_loop(apple1_t *m)
+{
+    uint16_t pc = m->cpu.pc;
+    uint8_t op = read_memory(m, pc);
+    if (op != 0x10 && op != 0x30) // BPL, BMI
+    {
+        return 0;
+    }
+    int8_t offset = (int8_t)read_memory(m, pc + 1);
+    return offset < 0 && offset >= -(3 + 2 + 8); // Poll plus up to 8 bytes
+}
+
+// A jump or branch to itself, which the 6502 can only leave through an
+// interrupt, and the Apple-1 has none
+static int jumps_to_itself(apple1_t *m, uint16_t pc)
+{
+    uint8_t op = read_memory(m, pc);
+    if (op == 0x4C) // JMP abs
+    {
+        return (read_memory(m, pc + 1) | read_memory(m, pc + 2) << 8) == pc;
+    }
+    return (op & 0x1F) == 0x10 && read_memory(m, pc + 1) == 0xFE; // Bxx *
+}
+
+// Checked once per run_emulator() call instead of after every instruction:
+// the 6502 sitting on a jump to itself at the end of two slices in a row is
+// reported, once
+static void check_stuck(apple1_t *m)
+{
+    const cpu6502_t *cpu = &m->cpu;
+    if (cpu->pc != m->stuck_pc || !jumps_to_itself(m, cpu->pc))
+    {
+        m->stuck_pc = cpu->pc;
+        m->stuck_reported = 0;
+        return;
+    }
+    if (m->stuck_reported)
+    {
+        return;
+    }
+    m->stuck_reported = 1;
+    printf("CPU stuck at PC=%04X A=%02X X=%02X Y=%02X SP=%02X\n", cpu->pc, cpu->a, cpu->x,
+           cpu->y, cpu->sp);
+    printf("Memory at PC: %02X %02X %02X\n", read_memory(m, cpu->pc),
+           read_memory(m, cpu->pc + 1), read_memory(m, cpu->pc + 2));
+#ifdef FAKE6502_TRACE
+    trace_print(m); // How it got there
+#endif
+}
+
+// One run6502() batch, noting whether it ended in a key-wait loop
+static uint32_t run_batch(apple1_t *m, uint32_t cycles)
+{
+    uint8_t counting = !m->prompt_seen; // Up to and including the prompt
+    m->kbd_poll = 0;
+    uint32_t done = run6502(&m->cpu, cycles);
+    if (m->kbd_poll && in_key_wait_loop(m))
+    {
+        m->kbd_wait = 1;
+    }
+    if (counting)
+    {
+        m->reset_cycles += done;
+    }
+    return done;
+}
+
+uint32_t run_emulator(apple1_t *m, uint32_t cycles)
+{
+    uint32_t done = 0;
+
+    // run6502() returns early when the output queue fills or the display is
+    // polled busy, and on empty keyboard polls. Carry on as long as the
+    // display has taken something meanwhile, but give the rest of the slice
+    // back once the 6502 is only waiting for the display or a key.
+    // The slice also ends at the prompt after a reset, so it can be timed.
+    uint8_t counting = !m->prompt_seen;
+    m->kbd_wait = 0;
+#ifdef FAKE6502_DEBUG
+    // Stopped in the debugger counts as waiting for a key, so the CPU side
+    // parks
+    if (debugger_halted(m))
+    {
+        m->kbd_wait = 1;
+        return 0;
+    }
+#endif
+    while (done < cycles && !m->kbd_wait && spsc_free(&m->dsp_queue) > 0)
+    {
+        done += run_batch(m, cycles - done);
+        if (counting && m->prompt_seen)
+        {
+            break;
+        }
+#ifdef FAKE6502_DEBUG
+        if (debugger_stopped(m))
+        {
+            m->kbd_wait = 1;
+            break;
+        }
+#endif
+    }
+    check_stuck(m);
+    return done;
+}
+
+uint32_t emulator_type_headless(apple1_t *m, const char *text, uint32_t len,
+                                void (*output)(void *context, char c), void *context,
+                                uint32_t max_cycles)
+{
+    // A key the user typed stays latched for afterwards
+    uint8_t saved_data = m->kbd_data;
+    uint8_t saved_strobe = m->kbd_strobe;
+    m->kbd_strobe = 0;
+
+    // feed_last carries over, so a CR LF split between calls is one CR
+    m->feed_next = text;
+    m->feed_end = text + len;
+    m->feed_output = output;
+    m->feed_context = context;
+
+    uint32_t done = 0;
+    m->kbd_wait = 0;
+    while (done < max_cycles && !m->kbd_wait)
+    {
+        done += run_batch(m, max_cycles - done);
+    }
+
+    m->feed_output = NULL;
+    m->kbd_data = saved_data;
+    m->kbd_strobe = saved_strobe;
+    return done;
+}
+
+int emulator_waiting_for_key(apple1_t *m)
+{
+    return m->kbd_wait;
+}
+
+int emulator_key_pending(apple1_t *m)
+{
+    return m->kbd_strobe || spsc_count(&m->key_queue) > 0;
+}
+
+int emulator_output_full(apple1_t *m)
+{
+    return spsc_free(&m->dsp_queue) == 0;
+}
+
+void step_emulator(apple1_t *m)
+{
+    uint8_t counting = !m->prompt_seen;
+    uint32_t cycles = step6502(&m->cpu);
+    if (counting)
+    {
+        m->reset_cycles += cycles;
     }
-    
-    last_pc = PC;
 }
\ No newline at end of file
@@ -11,100 +11,134 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 #include "fake6502.h"
 
-static void (*addrtable[256])();
-static void (*optable[256])();
-static uint8_t penaltyop, penaltyaddr;
-static uint64_t clockticks6502;
-
-uint16_t PC;
-uint8_t SP, A, X, Y;
-static bool C, Z, I, D, V, N;
-static uint16_t ea;
-static uint8_t opcode;
+// All state lives in the cpu6502_t each function is passed. The original
+// core keeps its names for it; up to the fused dispatch below they stand for
+// the fields of `cpu`.
+#define PC cpu->pc
+#define SP cpu->sp
+#define A cpu->a
+#define X cpu->x
+#define Y cpu->y
+#define C cpu->c
+#define Z cpu->z
+#define I cpu->i
+#define D cpu->d
+#define V cpu->v
+#define N cpu->n
+#define ea cpu->ea
+#define opcode cpu->opcode
+#define penaltyop cpu->penaltyop
+#define penaltyaddr cpu->penaltyaddr
+#define clockticks6502 cpu->clockticks
+
+_Static_assert(_Alignof(cpu6502_t) == CACHE_LINE6502,
+               "cpu6502_t doesn't start on a cache line");
+_Static_assert(offsetof(cpu6502_t, read_pages) <= CACHE_LINE6502,
+               "the per-instruction fields of cpu6502_t outgrew a cache line");
+
+static void (*addrtable[256])(cpu6502_t *);
+static void (*optable[256])(cpu6502_t *);
 
 // ------------------ Flags ---------------------------------------------------
 
-static inline void calcZ  (uint8_t  x) { Z = !x; }
-static inline void calcN  (uint8_t  x) { N = x & 0x80; }
-static inline void calcZN (uint8_t x)  { calcZ(x), calcN(x); }
-static inline void calcC  (uint16_t x) { C = x & 0xff00; }
-static inline void calcCZN(uint16_t x) { calcC(x), calcZN(x); }
+static inline void calcZ  (cpu6502_t *cpu, uint8_t  x) { Z = !x; }
+static inline void calcN  (cpu6502_t *cpu, uint8_t  x) { N = x & 0x80; }
+static inline void calcZN (cpu6502_t *cpu, uint8_t x)  { calcZ(cpu, x), calcN(cpu, x); }
+static inline void calcC  (cpu6502_t *cpu, uint16_t x) { C = x & 0xff00; }
+static inline void calcCZN(cpu6502_t *cpu, uint16_t x) { calcC(cpu, x), calcZN(cpu, x); }
 
-static inline void calcV(uint16_t result, uint8_t accu, uint16_t value) {
+static inline void calcV(cpu6502_t *cpu, uint16_t result, uint8_t accu, uint16_t value) {
     V = (result ^ accu) & (result ^ value) & 0x80;
 }
 
-void setP(uint8_t x) {
+void setP(cpu6502_t *cpu, uint8_t x) {
     N=x&0x80, V=x&0x40, D=x&8, I=x&4, Z=x&2, C=x&1;
 }
 
-uint8_t getP(void){ return (N<<7)|(V<<6)|(1<<5)|(0<<4)|(D<<3)|(I<<2)|(Z<<1)|C;}
+uint8_t getP(const cpu6502_t *cpu){ return (N<<7)|(V<<6)|(1<<5)|(0<<4)|(D<<3)|(I<<2)|(Z<<1)|C;}
+
+// ------------------ Page map ------------------------------------------------
+
+// Pages with a direct pointer are accessed in place, the rest (I/O) go
+// through the bus callbacks
+
+static inline uint8_t rd(cpu6502_t *cpu, uint16_t address) {
+    const uint8_t *page = cpu->read_pages[address >> 8];
+    return page ? page[address & 0xff] : cpu->read(cpu->context, address);
+}
+
+static inline void wr(cpu6502_t *cpu, uint16_t address, uint8_t value) {
+    uint8_t *page = cpu->write_pages[address >> 8];
+    if (page) page[address & 0xff] = value; else cpu->write(cpu->context, address, value);
+}
 
 // ----------------------------------------------------------------------------
 
-static void push16(uint16_t pushval) {
-    write6502(0x0100 + SP, (pushval >> 8) & 0xFF);
-    write6502(0x0100 + ((SP - 1) & 0xFF), pushval & 0xFF);
+static void push16(cpu6502_t *cpu, uint16_t pushval) {
+    wr(cpu, 0x0100 + SP, (pushval >> 8) & 0xFF);
+    wr(cpu, 0x0100 + ((SP - 1) & 0xFF), pushval & 0xFF);
     SP -= 2;
 }
 
-static void push8(uint8_t pushval) { write6502(0x0100 + SP--, pushval); }
-static uint8_t pull8() { return read6502(0x0100 + ++SP); }
+static void push8(cpu6502_t *cpu, uint8_t pushval) { wr(cpu, 0x0100 + SP--, pushval); }
+static uint8_t pull8(cpu6502_t *cpu) { return rd(cpu, 0x0100 + ++SP); }
 
-static uint16_t pull16() {
+static uint16_t pull16(cpu6502_t *cpu) {
     SP += 2;
-    return read6502(0x0100 + ((SP - 1) & 0xFF)) | \
-          (read6502(0x0100 + ((SP    ) & 0xFF)) << 8);
+    return rd(cpu, 0x0100 + ((SP - 1) & 0xFF)) |                             \
+          (rd(cpu, 0x0100 + ((SP    ) & 0xFF)) << 8);
 }
 
-static uint16_t read6502word(uint16_t addr) {
-    return read6502(addr) | (read6502(addr+1) << 8);
+static uint16_t read6502word(cpu6502_t *cpu, uint16_t addr) {
+    return rd(cpu, addr) | (rd(cpu, addr+1) << 8);
 }
 
 // ------------------ Addressing modes ----------------------------------------
 
-static void imp()  { }
-static void acc()  { }
-static void imm()  { ea = PC++; }
-static void zp()   { ea = read6502(PC++); }
-static void zpx()  { ea = (read6502(PC++) + X) & 0xff; }
-static void zpy()  { ea = (read6502(PC++) + Y) & 0xff; }
-static void abso() { ea = read6502word(PC); PC += 2; }
-static void rel()  { ea = PC+1; ea += (int8_t )read6502(PC++); }
-
-static void absx() {
-    ea = read6502word(PC);
+static void imp(cpu6502_t *cpu)  { (void)cpu; }
+static void acc(cpu6502_t *cpu)  { (void)cpu; }
+static void imm(cpu6502_t *cpu)  { ea = PC++; }
+static void zp(cpu6502_t *cpu)   { ea = rd(cpu, PC++); }
+static void zpx(cpu6502_t *cpu)  { ea = (rd(cpu, PC++) + X) & 0xff; }
+static void zpy(cpu6502_t *cpu)  { ea = (rd(cpu, PC++) + Y) & 0xff; }
+static void abso(cpu6502_t *cpu) { ea = read6502word(cpu, PC); PC += 2; }
+static void rel(cpu6502_t *cpu)  { ea = PC+1; ea += (int8_t )rd(cpu, PC++); }
+
+static void absx(cpu6502_t *cpu) {
+    ea = read6502word(cpu, PC);
     uint16_t startpage = ea & 0xff00;
     ea += X;
     penaltyaddr = startpage != (ea & 0xff00);     // page crossing
     PC += 2;
 }
 
-static void absy() {
-    ea = read6502word(PC);
+static void absy(cpu6502_t *cpu) {
+    ea = read6502word(cpu, PC);
     uint16_t startpage = ea & 0xff00;
     ea += Y;
     penaltyaddr = startpage != (ea & 0xff00);     // page crossing
     PC += 2;
 }
 
-static void ind() {
-    ea = read6502word(PC);
+static void ind(cpu6502_t *cpu) {
+    ea = read6502word(cpu, PC);
     uint16_t ea2 = (ea & 0xff00) | ((ea + 1) & 0xff); // page wrap bug!
-    ea = read6502(ea) | (read6502(ea2) << 8);
+    ea = rd(cpu, ea) | (rd(cpu, ea2) << 8);
     PC += 2;
 }
 
-static void indx() {
-    ea = ((read6502(PC++) + X) & 0xff);             // page wraparound
-    ea = read6502(ea) | (read6502((ea+1) & 0xff) << 8);
+static void indx(cpu6502_t *cpu) {
+    ea = ((rd(cpu, PC++) + X) & 0xff);             // page wraparound
+    ea = rd(cpu, ea) | (rd(cpu, (ea+1) & 0xff) << 8);
 }
 
-static void indy() { // (indirect),Y
-    ea = read6502(PC++);
-    ea = read6502(ea) | (read6502((ea+1) & 0xff) << 8);  // page wrap
+static void indy(cpu6502_t *cpu) { // (indirect),Y
+    ea = rd(cpu, PC++);
+    ea = rd(cpu, ea) | (rd(cpu, (ea+1) & 0xff) << 8);  // page wrap
     uint16_t startpage = ea & 0xff00;
     ea += Y;
     penaltyaddr = startpage != (ea & 0xff00);     // page cross penalty
@@ -112,21 +146,21 @@ static void indy() { // (indirect),Y
 
 // ----------------------------------------------------------------------------
 
-static inline uint16_t getvalue() {
-    return addrtable[opcode] == acc ? A : read6502(ea);
+static inline uint16_t getvalue(cpu6502_t *cpu) {
+    return addrtable[opcode] == acc ? A : rd(cpu, ea);
 }
 
-static inline void putvalue(uint16_t saveval) {
-    if (addrtable[opcode] == acc) A = saveval; else write6502(ea, saveval);
+static inline void putvalue(cpu6502_t *cpu, uint16_t saveval) {
+    if (addrtable[opcode] == acc) A = saveval; else wr(cpu, ea, saveval);
 }
 
 // ------------------ Opcodes -------------------------------------------------
 
-static void and() { penaltyop = 1; calcZN(A = A & getvalue()); }
-static void eor() { penaltyop = 1; A = A ^ getvalue(); calcZN(A); }
-static void ora() { penaltyop = 1; A |= getvalue(); calcZN(A); }
+static void and(cpu6502_t *cpu) { penaltyop = 1; calcZN(cpu, A = A & getvalue(cpu)); }
+static void eor(cpu6502_t *cpu) { penaltyop = 1; A = A ^ getvalue(cpu); calcZN(cpu, A); }
+static void ora(cpu6502_t *cpu) { penaltyop = 1; A |= getvalue(cpu); calcZN(cpu, A); }
 
-static void branch(bool condition) {
+static void branch(cpu6502_t *cpu, bool condition) {
     if (condition) {
         uint16_t oldpc = PC;    // for page cross check
         PC = ea;
@@ -135,117 +169,117 @@ static void branch(bool condition) {
     }
 }
 
-static void bcc() { branch(!C); }
-static void bcs() { branch( C); }
-static void bne() { branch(!Z); }
-static void beq() { branch( Z); }
-static void bpl() { branch(!N); }
-static void bmi() { branch( N); }
-static void bvc() { branch(!V); }
-static void bvs() { branch( V); }
-
-static void clc() { C = 0; }
-static void sec() { C = 1; }
-static void cld() { D = 0; }
-static void sed() { D = 1; }
-static void cli() { I = 0; }
-static void sei() { I = 1; }
-static void clv() { V = 0; }
-
-static void inx() { calcZN(++X); }
-static void iny() { calcZN(++Y); }
-static void dex() { calcZN(--X); }
-static void dey() { calcZN(--Y); }
-
-static void jmp() { PC = ea; }
-static void jsr() { push16(PC - 1); PC = ea; }
-
-static void lda() { penaltyop = 1; A = getvalue(); calcZN(A); }
-static void ldx() { penaltyop = 1; X = getvalue(); calcZN(X); }
-static void ldy() { penaltyop = 1; Y = getvalue(); calcZN(Y); }
-static void sta() { putvalue(A); }
-static void stx() { putvalue(X); }
-static void sty() { putvalue(Y); }
-
-static inline void compare(uint8_t reg, uint8_t value) {
-    calcN(reg - value);
+static void bcc(cpu6502_t *cpu) { branch(cpu, !C); }
+static void bcs(cpu6502_t *cpu) { branch(cpu,  C); }
+static void bne(cpu6502_t *cpu) { branch(cpu, !Z); }
+static void beq(cpu6502_t *cpu) { branch(cpu,  Z); }
+static void bpl(cpu6502_t *cpu) { branch(cpu, !N); }
+static void bmi(cpu6502_t *cpu) { branch(cpu,  N); }
+static void bvc(cpu6502_t *cpu) { branch(cpu, !V); }
+static void bvs(cpu6502_t *cpu) { branch(cpu,  V); }
+
+static void clc(cpu6502_t *cpu) { C = 0; }
+static void sec(cpu6502_t *cpu) { C = 1; }
+static void cld(cpu6502_t *cpu) { D = 0; }
+static void sed(cpu6502_t *cpu) { D = 1; }
+static void cli(cpu6502_t *cpu) { I = 0; }
+static void sei(cpu6502_t *cpu) { I = 1; }
+static void clv(cpu6502_t *cpu) { V = 0; }
+
+static void inx(cpu6502_t *cpu) { calcZN(cpu, ++X); }
+static void iny(cpu6502_t *cpu) { calcZN(cpu, ++Y); }
+static void dex(cpu6502_t *cpu) { calcZN(cpu, --X); }
+static void dey(cpu6502_t *cpu) { calcZN(cpu, --Y); }
+
+static void jmp(cpu6502_t *cpu) { PC = ea; }
+static void jsr(cpu6502_t *cpu) { push16(cpu, PC - 1); PC = ea; }
+
+static void lda(cpu6502_t *cpu) { penaltyop = 1; A = getvalue(cpu); calcZN(cpu, A); }
+static void ldx(cpu6502_t *cpu) { penaltyop = 1; X = getvalue(cpu); calcZN(cpu, X); }
+static void ldy(cpu6502_t *cpu) { penaltyop = 1; Y = getvalue(cpu); calcZN(cpu, Y); }
+static void sta(cpu6502_t *cpu) { putvalue(cpu, A); }
+static void stx(cpu6502_t *cpu) { putvalue(cpu, X); }
+static void sty(cpu6502_t *cpu) { putvalue(cpu, Y); }
+
+static inline void compare(cpu6502_t *cpu, uint8_t reg, uint8_t value) {
+    calcN(cpu, reg - value);
     C = reg >= value;
     Z = reg == value;
 }
-static void cmp() { compare(A, getvalue()); penaltyop = 1; }
-static void cpx() { compare(X, getvalue()); }
-static void cpy() { compare(Y, getvalue()); }
+static void cmp(cpu6502_t *cpu) { compare(cpu, A, getvalue(cpu)); penaltyop = 1; }
+static void cpx(cpu6502_t *cpu) { compare(cpu, X, getvalue(cpu)); }
+static void cpy(cpu6502_t *cpu) { compare(cpu, Y, getvalue(cpu)); }
 
-static void pha() { push8(A); }
-static void php() { push8(getP() | 0x10); }
-static void pla() { A = pull8(); calcZN(A); }
-static void plp() { uint8_t P = pull8(); setP(P); }
+static void pha(cpu6502_t *cpu) { push8(cpu, A); }
+static void php(cpu6502_t *cpu) { push8(cpu, getP(cpu) | 0x10); }
+static void pla(cpu6502_t *cpu) { A = pull8(cpu); calcZN(cpu, A); }
+static void plp(cpu6502_t *cpu) { uint8_t P = pull8(cpu); setP(cpu, P); }
 
-static void rti() { uint8_t P = pull8(); setP(P); PC = pull16(); }
-static void rts() { PC = pull16() + 1; }
+static void rti(cpu6502_t *cpu) { uint8_t P = pull8(cpu); setP(cpu, P); PC = pull16(cpu); }
+static void rts(cpu6502_t *cpu) { PC = pull16(cpu) + 1; }
 
-static void tax() { X = A; calcZN(X); }
-static void tay() { Y = A; calcZN(Y); }
-static void tsx() { X = SP; calcZN(X); }
-static void txa() { A = X; calcZN(A); }
-static void txs() { SP = X; }
-static void tya() { A = Y; calcZN(A); }
+static void tax(cpu6502_t *cpu) { X = A; calcZN(cpu, X); }
+static void tay(cpu6502_t *cpu) { Y = A; calcZN(cpu, Y); }
+static void tsx(cpu6502_t *cpu) { X = SP; calcZN(cpu, X); }
+static void txa(cpu6502_t *cpu) { A = X; calcZN(cpu, A); }
+static void txs(cpu6502_t *cpu) { SP = X; }
+static void tya(cpu6502_t *cpu) { A = Y; calcZN(cpu, A); }
 
-static void bit() {
-    uint16_t value = getvalue();
-    calcZ(A & value);
+static void bit(cpu6502_t *cpu) {
+    uint16_t value = getvalue(cpu);
+    calcZ(cpu, A & value);
     N = value & 0x80;
     V = value & 0x40;
 }
 
-static void brk() {
-    push16(++PC);                 // address before next instruction
-    php();
+static void brk(cpu6502_t *cpu) {
+    push16(cpu, ++PC);                 // address before next instruction
+    php(cpu);
     I = 1;
-    PC = read6502word(0xfffe);
+    PC = read6502word(cpu, 0xfffe);
 }
 
-static void dec() {
-    uint16_t result = getvalue() - 1;
-    calcZN(result);
-    putvalue(result);
+static void dec(cpu6502_t *cpu) {
+    uint16_t result = getvalue(cpu) - 1;
+    calcZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void inc() {
-    uint16_t result = getvalue() + 1;
-    calcZN(result);
-    putvalue(result);
+static void inc(cpu6502_t *cpu) {
+    uint16_t result = getvalue(cpu) + 1;
+    calcZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void asl() {
-    uint16_t result = getvalue() << 1;
-    calcCZN(result);
-    putvalue(result);
+static void asl(cpu6502_t *cpu) {
+    uint16_t result = getvalue(cpu) << 1;
+    calcCZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void lsr() {
-    uint16_t value = getvalue();
+static void lsr(cpu6502_t *cpu) {
+    uint16_t value = getvalue(cpu);
     uint16_t result = value >> 1;
     C = value & 1;
-    calcZN(result);
-    putvalue(result);
+    calcZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void rol() {
-    uint16_t result = (getvalue() << 1) | C;
-    calcCZN(result);
-    putvalue(result);
+static void rol(cpu6502_t *cpu) {
+    uint16_t result = (getvalue(cpu) << 1) | C;
+    calcCZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void ror() {
-    uint16_t value = getvalue();
+static void ror(cpu6502_t *cpu) {
+    uint16_t value = getvalue(cpu);
     uint16_t result = (value >> 1) | (C << 7);
     C = value & 1;
-    calcZN(result);
-    putvalue(result);
+    calcZN(cpu, result);
+    putvalue(cpu, result);
 }
 
-static void nop() {
+static void nop(cpu6502_t *cpu) {
     switch (opcode) {
         case 0x1C:
         case 0x3C:
@@ -258,37 +292,37 @@ static void nop() {
     }
 }
 
-static void adc() {
+static void adc(cpu6502_t *cpu) {
     penaltyop = 1;
-    uint16_t value = getvalue();
+    uint16_t value = getvalue(cpu);
     uint16_t result = A + value + C;
-    calcZ(result);
+    calcZ(cpu, result);
 
     if (!D) {
-        calcC(result);
-        calcV(result, A, value);
-        calcN(result);
+        calcC(cpu, result);
+        calcV(cpu, result, A, value);
+        calcN(cpu, result);
     } else {
         result = (A & 0x0f) + (value & 0x0f) + C;
         if (result >= 0x0a) result = ((result + 0x06) & 0x0f) + 0x10;
         result += (A & 0xf0) + (value & 0xf0);
-        calcN(result);
-        calcV(result, A, value);
+        calcN(cpu, result);
+        calcV(cpu, result, A, value);
         if (result >= 0xa0) result += 0x60;
-        calcC(result);
+        calcC(cpu, result);
         clockticks6502++;
     }
 
     A = result;
 }
 
-static void sbc() {
+static void sbc(cpu6502_t *cpu) {
     bool cC = C;
     penaltyop = 1;
-    uint16_t value = getvalue() ^ 0xff;
+    uint16_t value = getvalue(cpu) ^ 0xff;
     uint16_t result = A + value + C;
-    calcCZN(result);
-    calcV(result, A, value);
+    calcCZN(cpu, result);
+    calcV(cpu, result, A, value);
 
     if (D) {
         uint16_t AL, B;
@@ -305,28 +339,28 @@ static void sbc() {
 
 // ------------------ Stable undocumented opcodes -----------------------------
 
-static void SLO() { asl(); ora(); }
-static void RLA() { rol(); and(); penaltyop = 0; }
-static void SRE() { lsr(); eor(); penaltyop = 0; }
-static void RRA() { ror(); adc(); penaltyop = 0; if (D) clockticks6502--; }
-static void SAX() { putvalue(A & X); }
-static void LAX() { penaltyop = 1; lda(); ldx(); }
-static void DCP() { dec(); cmp(); penaltyop = 0; }
-static void ISC() { inc(); sbc(); penaltyop = 0; if (D) clockticks6502--; }
-static void ANC() { and(); C = A & 0x80; }
-static void ALR() { and(); C = A & 1; A >>= 1; calcZN(A); }
-static void LAS() { penaltyop = 1; calcZN(SP = A = X = getvalue() & SP); }
-static void JAM() { nop(); }
+static void SLO(cpu6502_t *cpu) { asl(cpu); ora(cpu); }
+static void RLA(cpu6502_t *cpu) { rol(cpu); and(cpu); penaltyop = 0; }
+static void SRE(cpu6502_t *cpu) { lsr(cpu); eor(cpu); penaltyop = 0; }
+static void RRA(cpu6502_t *cpu) { ror(cpu); adc(cpu); penaltyop = 0; if (D) clockticks6502--; }
+static void SAX(cpu6502_t *cpu) { putvalue(cpu, A & X); }
+static void LAX(cpu6502_t *cpu) { penaltyop = 1; lda(cpu); ldx(cpu); }
+static void DCP(cpu6502_t *cpu) { dec(cpu); cmp(cpu); penaltyop = 0; }
+static void ISC(cpu6502_t *cpu) { inc(cpu); sbc(cpu); penaltyop = 0; if (D) clockticks6502--; }
+static void ANC(cpu6502_t *cpu) { and(cpu); C = A & 0x80; }
+static void ALR(cpu6502_t *cpu) { and(cpu); C = A & 1; A >>= 1; calcZN(cpu, A); }
+static void LAS(cpu6502_t *cpu) { penaltyop = 1; calcZN(cpu, SP = A = X = getvalue(cpu) & SP); }
+static void JAM(cpu6502_t *cpu) { nop(cpu); }
 
 
-static void ARR() {
-    and();
+static void ARR(cpu6502_t *cpu) {
+    and(cpu);
 
     uint8_t inA = A;
 
     A >>= 1;
     A |= C << 7;
-    calcZN(A);
+    calcZN(cpu, A);
 
     if (!D) {
         C = A & 0x40;
@@ -344,39 +378,39 @@ static void ARR() {
     }
 }
 
-static void SBX() {
-    uint8_t value = getvalue();
+static void SBX(cpu6502_t *cpu) {
+    uint8_t value = getvalue(cpu);
     X &= A;
-    compare(X, value);
+    compare(cpu, X, value);
     X -= value;
 }
 
 // ------------------ Unstable undocumented opcodes ---------------------------
 
-static void SHA() { putvalue(A & X & ((ea >> 8) + 1)); }
-static void SHX() {
+static void SHA(cpu6502_t *cpu) { putvalue(cpu, A & X & ((ea >> 8) + 1)); }
+static void SHX(cpu6502_t *cpu) {
     uint8_t value = X & (((ea - Y) >> 8) + 1);
     if (((ea - Y) & 0xff) + Y > 0xff)
         ea = (ea & 0xff) | value << 8;
-    putvalue(value);
+    putvalue(cpu, value);
 }
-static void SHY() {
+static void SHY(cpu6502_t *cpu) {
     uint8_t value = Y & (((ea-X) >> 8) + 1);
     if (((ea - X) & 0xff) + X > 0xff)
         ea = (ea & 0xff) | value << 8;
-    putvalue(value);
+    putvalue(cpu, value);
 }
-static void TAS() { SP = A & X; putvalue(SP & ((ea >> 8) + 1));
+static void TAS(cpu6502_t *cpu) { SP = A & X; putvalue(cpu, SP & ((ea >> 8) + 1));
 }
 
 // ------------------ Magic constants undocumented opcodes --------------------
 
-static void ANE() { A = (A | 0xef) & X & getvalue(); calcZN(A); }
-static void LXA() { A = X = ( A | 0xee) & getvalue(); calcZN(A); }
+static void ANE(cpu6502_t *cpu) { A = (A | 0xef) & X & getvalue(cpu); calcZN(cpu, A); }
+static void LXA(cpu6502_t *cpu) { A = X = ( A | 0xee) & getvalue(cpu); calcZN(cpu, A); }
 
 // ----------------------------------------------------------------------------
 
-static void (*addrtable[256])() = {
+static void (*addrtable[256])(cpu6502_t *) = {
 // 0    1   2    3   4   5   6   7   8    9   A    B    C    D    E    F
   imp,indx,imp,indx, zp, zp, zp, zp,imp, imm,acc, imm,abso,abso,abso,abso, // 0
   rel,indy,imp,indy,zpx,zpx,zpx,zpx,imp,absy,imp,absy,absx,absx,absx,absx, // 1
@@ -396,7 +430,7 @@ static void (*addrtable[256])() = {
   rel,indy,imp,indy,zpx,zpx,zpx,zpx,imp,absy,imp,absy,absx,absx,absx,absx  // F
 };
 
-static void (*optable[256])() = {
+static void (*optable[256])(cpu6502_t *) = {
 //   0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F
     brk,ora,JAM,SLO,nop,ora,asl,SLO,php,ora,asl,ANC,nop,ora,asl,SLO, // 0
     bpl,ora,JAM,SLO,nop,ora,asl,SLO,clc,ora,nop,SLO,nop,ora,asl,SLO, // 1
@@ -436,39 +470,534 @@ static const uint32_t ticktable[256] = {
     2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7  // F
 };
 
-int nmi6502() {
-    push16(PC);
-    push8(getP());
-    I = 1;
-    PC = read6502word(0xfffa);
+#undef PC
+#undef SP
+#undef A
+#undef X
+#undef Y
+#undef C
+#undef Z
+#undef I
+#undef D
+#undef V
+#undef N
+#undef ea
+#undef opcode
+#undef penaltyop
+#undef penaltyaddr
+#undef clockticks6502
+
+// ------------------ Fused dispatch ------------------------------------------
+//
+// The same instruction set as the tables above, but every opcode is one case
+// of a single switch with its addressing mode and operation expanded inline.
+// There are no indirect calls, ea and the page-cross flag are locals, the
+// accumulator-vs-memory choice is made per opcode and only the opcodes that
+// take the page-cross penalty look at it. Registers live in a local copy for
+// the duration of the instruction. The bus traffic (order and number of
+// rd()/wr() calls) and cycle counts match the table core.
+
+typedef struct {
+    uint16_t pc;
+    uint8_t sp, a, x, y;
+    bool c, z, i, d, v, n;
+} regs_t;
+
+static inline void regs_load(regs_t *r, const cpu6502_t *cpu) {
+    r->pc = cpu->pc, r->sp = cpu->sp, r->a = cpu->a, r->x = cpu->x, r->y = cpu->y;
+    r->c = cpu->c, r->z = cpu->z, r->i = cpu->i, r->d = cpu->d, r->v = cpu->v, r->n = cpu->n;
+}
+
+static inline void regs_store(cpu6502_t *cpu, const regs_t *r) {
+    cpu->pc = r->pc, cpu->sp = r->sp, cpu->a = r->a, cpu->x = r->x, cpu->y = r->y;
+    cpu->c = r->c, cpu->z = r->z, cpu->i = r->i, cpu->d = r->d, cpu->v = r->v, cpu->n = r->n;
+}
+
+static inline uint16_t rd16(cpu6502_t *cpu, uint16_t addr) {
+    return rd(cpu, addr) | (rd(cpu, addr+1) << 8);
+}
+
+static inline void f_zn(regs_t *r, uint8_t x) { r->z = !x; r->n = x & 0x80; }
+static inline void f_czn(regs_t *r, uint16_t x) { r->c = x & 0xff00; f_zn(r, x); }
+
+static inline void f_v(regs_t *r, uint16_t result, uint8_t accu, uint16_t value) {
+    r->v = (result ^ accu) & (result ^ value) & 0x80;
+}
+
+static inline uint8_t f_getp(const regs_t *r) {
+    return (r->n<<7)|(r->v<<6)|(1<<5)|(r->d<<3)|(r->i<<2)|(r->z<<1)|r->c;
+}
+
+static inline void f_setp(regs_t *r, uint8_t x) {
+    r->n=x&0x80, r->v=x&0x40, r->d=x&8, r->i=x&4, r->z=x&2, r->c=x&1;
+}
+
+static inline void f_compare(regs_t *r, uint8_t reg, uint8_t value) {
+    r->n = (uint8_t)(reg - value) & 0x80;
+    r->c = reg >= value;
+    r->z = reg == value;
+}
+
+static inline void f_push8(cpu6502_t *cpu, regs_t *r, uint8_t v) { wr(cpu, 0x0100 + r->sp--, v); }
+static inline uint8_t f_pull8(cpu6502_t *cpu, regs_t *r) { return rd(cpu, 0x0100 + ++r->sp); }
+
+static inline void f_push16(cpu6502_t *cpu, regs_t *r, uint16_t v) {
+    wr(cpu, 0x0100 + r->sp, (v >> 8) & 0xFF);
+    wr(cpu, 0x0100 + ((r->sp - 1) & 0xFF), v & 0xFF);
+    r->sp -= 2;
+}
+
+static inline uint16_t f_pull16(cpu6502_t *cpu, regs_t *r) {
+    r->sp += 2;
+    return rd(cpu, 0x0100 + ((r->sp - 1) & 0xFF)) |                          \
+          (rd(cpu, 0x0100 + ((r->sp    ) & 0xFF)) << 8);
+}
+
+// Returns the extra cycle taken in decimal mode
+static inline uint32_t f_adc(regs_t *r, uint16_t value) {
+    uint16_t result = r->a + value + r->c;
+    r->z = !(uint8_t)result;
+
+    if (!r->d) {
+        r->c = result & 0xff00;
+        f_v(r, result, r->a, value);
+        r->n = (uint8_t)result & 0x80;
+        r->a = result;
+        return 0;
+    }
+
+    result = (r->a & 0x0f) + (value & 0x0f) + r->c;
+    if (result >= 0x0a) result = ((result + 0x06) & 0x0f) + 0x10;
+    result += (r->a & 0xf0) + (value & 0xf0);
+    r->n = (uint8_t)result & 0x80;
+    f_v(r, result, r->a, value);
+    if (result >= 0xa0) result += 0x60;
+    r->c = result & 0xff00;
+    r->a = result;
+    return 1;
+}
+
+static inline uint32_t f_sbc(regs_t *r, uint8_t operand) {
+    bool cC = r->c;
+    uint16_t value = operand ^ 0xff;
+    uint16_t result = r->a + value + r->c;
+    f_czn(r, result);
+    f_v(r, result, r->a, value);
+
+    if (!r->d) {
+        r->a = result;
+        return 0;
+    }
+
+    uint16_t AL, B;
+    B = value ^ 0xff;
+    AL = (r->a & 0x0f) - (B & 0x0f) + cC - 1;
+    if(AL & 0x8000)  AL =  ((AL - 0x06) & 0x0f) - 0x10;
+    result = (r->a & 0xf0) - (B & 0xf0) + AL;
+    if(result & 0x8000) result -= 0x60;
+    r->a = result;
+    return 1;
+}
+
+static inline void f_arr(regs_t *r) {
+    uint8_t inA = r->a;
+
+    r->a >>= 1;
+    r->a |= r->c << 7;
+    f_zn(r, r->a);
+
+    if (!r->d) {
+        r->c = r->a & 0x40;
+        r->v = r->c ^ ((r->a >> 5) & 1);
+    } else {
+        r->v = (r->a ^ inA) & 0x40;
+        if (((inA & 0x0f) + (inA & 0x01)) > 0x05)
+            r->a = (r->a & 0xf0) | ((r->a + 0x06) & 0x0f);
+        if ((uint16_t)inA + (inA & 0x10) >= 0x60) {
+            r->a += 0x60;
+            r->c = 1;
+        } else {
+            r->c = 0;
+        }
+    }
+}
+
+#define GET()   rd(cpu, ea)
+#define PUT(v)  wr(cpu, ea, (v))
+#define PEN     ticks += pen
+
+// Addressing modes: leave the operand address in ea, pen set on page cross
+#define M_IMP
+#define M_ACC
+#define M_IMM   ea = r->pc++;
+#define M_ZP    ea = rd(cpu, r->pc++);
+#define M_ZPX   ea = (rd(cpu, r->pc++) + r->x) & 0xff;
+#define M_ZPY   ea = (rd(cpu, r->pc++) + r->y) & 0xff;
+#define M_ABS   ea = rd16(cpu, r->pc); r->pc += 2;
+#define M_REL   ea = r->pc + 1; ea += (int8_t)rd(cpu, r->pc++);
+#define M_ABSX  ea = rd16(cpu, r->pc); pen = (ea & 0xff) + r->x > 0xff;      \
+                ea += r->x; r->pc += 2;
+#define M_ABSY  ea = rd16(cpu, r->pc); pen = (ea & 0xff) + r->y > 0xff;      \
+                ea += r->y; r->pc += 2;
+#define M_IND   { ea = rd16(cpu, r->pc);                                     \
+                  uint16_t ea2 = (ea & 0xff00) | ((ea + 1) & 0xff);          \
+                  ea = rd(cpu, ea) | (rd(cpu, ea2) << 8); r->pc += 2; }
+#define M_INDX  ea = (rd(cpu, r->pc++) + r->x) & 0xff;                       \
+                ea = rd(cpu, ea) | (rd(cpu, (ea+1) & 0xff) << 8);
+#define M_INDY  ea = rd(cpu, r->pc++);                                       \
+                ea = rd(cpu, ea) | (rd(cpu, (ea+1) & 0xff) << 8);            \
+                pen = (ea & 0xff) + r->y > 0xff; ea += r->y;
+
+#define BRANCH(cond) if (cond) { uint16_t oldpc = r->pc; r->pc = ea;         \
+                     ticks += ((oldpc & 0xFF00) != (r->pc & 0xFF00)) ? 2 : 1; }
+
+// Operations
+#define O_ORA   PEN; r->a |= GET(); f_zn(r, r->a);
+#define O_AND   PEN; r->a &= GET(); f_zn(r, r->a);
+#define O_EOR   PEN; r->a ^= GET(); f_zn(r, r->a);
+#define O_ADC   PEN; ticks += f_adc(r, GET());
+#define O_SBC   PEN; ticks += f_sbc(r, GET());
+#define O_CMP   PEN; f_compare(r, r->a, GET());
+#define O_CPX   f_compare(r, r->x, GET());
+#define O_CPY   f_compare(r, r->y, GET());
+#define O_LDA   PEN; r->a = GET(); f_zn(r, r->a);
+#define O_LDX   PEN; r->x = GET(); f_zn(r, r->x);
+#define O_LDY   PEN; r->y = GET(); f_zn(r, r->y);
+#define O_STA   PUT(r->a);
+#define O_STX   PUT(r->x);
+#define O_STY   PUT(r->y);
+
+#define O_BIT   { uint8_t v = GET(); r->z = !(r->a & v);                     \
+                  r->n = v & 0x80; r->v = v & 0x40; }
+
+#define O_ASL   { uint16_t t = GET() << 1; f_czn(r, t); PUT(t); }
+#define O_ROL   { uint16_t t = (GET() << 1) | r->c; f_czn(r, t); PUT(t); }
+#define O_LSR   { uint8_t v = GET(); r->c = v & 1; v >>= 1; f_zn(r, v); PUT(v); }
+#define O_ROR   { uint8_t v = GET(); uint8_t t = (v >> 1) | (r->c << 7);     \
+                  r->c = v & 1; f_zn(r, t); PUT(t); }
+#define O_DEC   { uint8_t t = GET() - 1; f_zn(r, t); PUT(t); }
+#define O_INC   { uint8_t t = GET() + 1; f_zn(r, t); PUT(t); }
+
+#define O_ASL_A { uint16_t t = r->a << 1; f_czn(r, t); r->a = t; }
+#define O_ROL_A { uint16_t t = (r->a << 1) | r->c; f_czn(r, t); r->a = t; }
+#define O_LSR_A { r->c = r->a & 1; r->a >>= 1; f_zn(r, r->a); }
+#define O_ROR_A { uint8_t t = (r->a >> 1) | (r->c << 7);                     \
+                  r->c = r->a & 1; r->a = t; f_zn(r, t); }
+
+#define O_BPL   BRANCH(!r->n)
+#define O_BMI   BRANCH( r->n)
+#define O_BVC   BRANCH(!r->v)
+#define O_BVS   BRANCH( r->v)
+#define O_BCC   BRANCH(!r->c)
+#define O_BCS   BRANCH( r->c)
+#define O_BNE   BRANCH(!r->z)
+#define O_BEQ   BRANCH( r->z)
+
+#define O_CLC   r->c = 0;
+#define O_SEC   r->c = 1;
+#define O_CLD   r->d = 0;
+#define O_SED   r->d = 1;
+#define O_CLI   r->i = 0;
+#define O_SEI   r->i = 1;
+#define O_CLV   r->v = 0;
+
+#define O_INX   f_zn(r, ++r->x);
+#define O_INY   f_zn(r, ++r->y);
+#define O_DEX   f_zn(r, --r->x);
+#define O_DEY   f_zn(r, --r->y);
+
+#define O_TAX   r->x = r->a; f_zn(r, r->x);
+#define O_TAY   r->y = r->a; f_zn(r, r->y);
+#define O_TSX   r->x = r->sp; f_zn(r, r->x);
+#define O_TXA   r->a = r->x; f_zn(r, r->a);
+#define O_TXS   r->sp = r->x;
+#define O_TYA   r->a = r->y; f_zn(r, r->a);
+
+#define O_PHA   f_push8(cpu, r, r->a);
+#define O_PHP   f_push8(cpu, r, f_getp(r) | 0x10);
+#define O_PLA   r->a = f_pull8(cpu, r); f_zn(r, r->a);
+#define O_PLP   f_setp(r, f_pull8(cpu, r));
+
+#define O_JMP   r->pc = ea;
+#define O_JSR   f_push16(cpu, r, r->pc - 1); r->pc = ea;
+#define O_RTS   r->pc = f_pull16(cpu, r) + 1;
+#define O_RTI   f_setp(r, f_pull8(cpu, r)); r->pc = f_pull16(cpu, r);
+#define O_BRK   f_push16(cpu, r, ++r->pc); f_push8(cpu, r, f_getp(r) | 0x10); \
+                r->i = 1; r->pc = rd16(cpu, 0xfffe);
+
+#define O_NOP   PEN;
+#define O_JAM
+
+// Stable undocumented opcodes
+#define O_SLO   O_ASL O_ORA
+#define O_RLA   O_ROL r->a &= GET(); f_zn(r, r->a);
+#define O_SRE   O_LSR r->a ^= GET(); f_zn(r, r->a);
+#define O_RRA   O_ROR f_adc(r, GET());
+#define O_SAX   PUT(r->a & r->x);
+#define O_LAX   PEN; r->a = GET(); f_zn(r, r->a); r->x = GET(); f_zn(r, r->x);
+#define O_DCP   O_DEC f_compare(r, r->a, GET());
+#define O_ISC   O_INC f_sbc(r, GET());
+#define O_ANC   O_AND r->c = r->a & 0x80;
+#define O_ALR   O_AND r->c = r->a & 1; r->a >>= 1; f_zn(r, r->a);
+#define O_LAS   PEN; r->sp = r->a = r->x = GET() & r->sp; f_zn(r, r->a);
+#define O_ARR   O_AND f_arr(r);
+#define O_SBX   { uint8_t v = GET(); r->x &= r->a;                           \
+                  f_compare(r, r->x, v); r->x -= v; }
+
+// Unstable undocumented opcodes
+#define O_SHA   PUT(r->a & r->x & ((ea >> 8) + 1));
+#define O_SHX   { uint8_t v = r->x & (((ea - r->y) >> 8) + 1);                \
+                  if (((ea - r->y) & 0xff) + r->y > 0xff)                      \
+                      ea = (ea & 0xff) | v << 8;                               \
+                  PUT(v); }
+#define O_SHY   { uint8_t v = r->y & (((ea - r->x) >> 8) + 1);                \
+                  if (((ea - r->x) & 0xff) + r->x > 0xff)                      \
+                      ea = (ea & 0xff) | v << 8;                               \
+                  PUT(v); }
+#define O_TAS   r->sp = r->a & r->x; PUT(r->sp & ((ea >> 8) + 1));
+
+// Magic constants undocumented opcodes
+#define O_ANE   r->a = (r->a | 0xef) & r->x & GET(); f_zn(r, r->a);
+#define O_LXA   r->a = r->x = (r->a | 0xee) & GET(); f_zn(r, r->a);
+
+#define OP(code, mode, op)                                                    \
+    case 0x##code: ticks = ticktable[0x##code]; M_##mode O_##op break;
+
+static inline __attribute__((always_inline)) uint32_t fused_exec(cpu6502_t *cpu, regs_t *r) {
+    uint16_t ea = 0;
+    uint8_t pen = 0;
+    uint32_t ticks = 0;
+
+    switch (rd(cpu, r->pc++)) {
+    OP(00,IMP,BRK) OP(01,INDX,ORA) OP(02,IMP,JAM) OP(03,INDX,SLO) OP(04,ZP,NOP) OP(05,ZP,ORA) OP(06,ZP,ASL) OP(07,ZP,SLO)
+    OP(08,IMP,PHP) OP(09,IMM,ORA) OP(0A,ACC,ASL_A) OP(0B,IMM,ANC) OP(0C,ABS,NOP) OP(0D,ABS,ORA) OP(0E,ABS,ASL) OP(0F,ABS,SLO)
+    OP(10,REL,BPL) OP(11,INDY,ORA) OP(12,IMP,JAM) OP(13,INDY,SLO) OP(14,ZPX,NOP) OP(15,ZPX,ORA) OP(16,ZPX,ASL) OP(17,ZPX,SLO)
+    OP(18,IMP,CLC) OP(19,ABSY,ORA) OP(1A,IMP,NOP) OP(1B,ABSY,SLO) OP(1C,ABSX,NOP) OP(1D,ABSX,ORA) OP(1E,ABSX,ASL) OP(1F,ABSX,SLO)
+    OP(20,ABS,JSR) OP(21,INDX,AND) OP(22,IMP,JAM) OP(23,INDX,RLA) OP(24,ZP,BIT) OP(25,ZP,AND) OP(26,ZP,ROL) OP(27,ZP,RLA)
+    OP(28,IMP,PLP) OP(29,IMM,AND) OP(2A,ACC,ROL_A) OP(2B,IMM,ANC) OP(2C,ABS,BIT) OP(2D,ABS,AND) OP(2E,ABS,ROL) OP(2F,ABS,RLA)
+    OP(30,REL,BMI) OP(31,INDY,AND) OP(32,IMP,JAM) OP(33,INDY,RLA) OP(34,ZPX,NOP) OP(35,ZPX,AND) OP(36,ZPX,ROL) OP(37,ZPX,RLA)
+    OP(38,IMP,SEC) OP(39,ABSY,AND) OP(3A,IMP,NOP) OP(3B,ABSY,RLA) OP(3C,ABSX,NOP) OP(3D,ABSX,AND) OP(3E,ABSX,ROL) OP(3F,ABSX,RLA)
+    OP(40,IMP,RTI) OP(41,INDX,EOR) OP(42,IMP,JAM) OP(43,INDX,SRE) OP(44,ZP,NOP) OP(45,ZP,EOR) OP(46,ZP,LSR) OP(47,ZP,SRE)
+    OP(48,IMP,PHA) OP(49,IMM,EOR) OP(4A,ACC,LSR_A) OP(4B,IMM,ALR) OP(4C,ABS,JMP) OP(4D,ABS,EOR) OP(4E,ABS,LSR) OP(4F,ABS,SRE)
+    OP(50,REL,BVC) OP(51,INDY,EOR) OP(52,IMP,JAM) OP(53,INDY,SRE) OP(54,ZPX,NOP) OP(55,ZPX,EOR) OP(56,ZPX,LSR) OP(57,ZPX,SRE)
+    OP(58,IMP,CLI) OP(59,ABSY,EOR) OP(5A,IMP,NOP) OP(5B,ABSY,SRE) OP(5C,ABSX,NOP) OP(5D,ABSX,EOR) OP(5E,ABSX,LSR) OP(5F,ABSX,SRE)
+    OP(60,IMP,RTS) OP(61,INDX,ADC) OP(62,IMP,JAM) OP(63,INDX,RRA) OP(64,ZP,NOP) OP(65,ZP,ADC) OP(66,ZP,ROR) OP(67,ZP,RRA)
+    OP(68,IMP,PLA) OP(69,IMM,ADC) OP(6A,ACC,ROR_A) OP(6B,IMM,ARR) OP(6C,IND,JMP) OP(6D,ABS,ADC) OP(6E,ABS,ROR) OP(6F,ABS,RRA)
+    OP(70,REL,BVS) OP(71,INDY,ADC) OP(72,IMP,JAM) OP(73,INDY,RRA) OP(74,ZPX,NOP) OP(75,ZPX,ADC) OP(76,ZPX,ROR) OP(77,ZPX,RRA)
+    OP(78,IMP,SEI) OP(79,ABSY,ADC) OP(7A,IMP,NOP) OP(7B,ABSY,RRA) OP(7C,ABSX,NOP) OP(7D,ABSX,ADC) OP(7E,ABSX,ROR) OP(7F,ABSX,RRA)
+    OP(80,IMM,NOP) OP(81,INDX,STA) OP(82,IMM,NOP) OP(83,INDX,SAX) OP(84,ZP,STY) OP(85,ZP,STA) OP(86,ZP,STX) OP(87,ZP,SAX)
+    OP(88,IMP,DEY) OP(89,IMM,NOP) OP(8A,IMP,TXA) OP(8B,IMM,ANE) OP(8C,ABS,STY) OP(8D,ABS,STA) OP(8E,ABS,STX) OP(8F,ABS,SAX)
+    OP(90,REL,BCC) OP(91,INDY,STA) OP(92,IMP,JAM) OP(93,INDY,SHA) OP(94,ZPX,STY) OP(95,ZPX,STA) OP(96,ZPY,STX) OP(97,ZPY,SAX)
+    OP(98,IMP,TYA) OP(99,ABSY,STA) OP(9A,IMP,TXS) OP(9B,ABSY,TAS) OP(9C,ABSX,SHY) OP(9D,ABSX,STA) OP(9E,ABSY,SHX) OP(9F,ABSY,SHA)
+    OP(A0,IMM,LDY) OP(A1,INDX,LDA) OP(A2,IMM,LDX) OP(A3,INDX,LAX) OP(A4,ZP,LDY) OP(A5,ZP,LDA) OP(A6,ZP,LDX) OP(A7,ZP,LAX)
+    OP(A8,IMP,TAY) OP(A9,IMM,LDA) OP(AA,IMP,TAX) OP(AB,IMM,LXA) OP(AC,ABS,LDY) OP(AD,ABS,LDA) OP(AE,ABS,LDX) OP(AF,ABS,LAX)
+    OP(B0,REL,BCS) OP(B1,INDY,LDA) OP(B2,IMP,JAM) OP(B3,INDY,LAX) OP(B4,ZPX,LDY) OP(B5,ZPX,LDA) OP(B6,ZPY,LDX) OP(B7,ZPY,LAX)
+    OP(B8,IMP,CLV) OP(B9,ABSY,LDA) OP(BA,IMP,TSX) OP(BB,ABSY,LAS) OP(BC,ABSX,LDY) OP(BD,ABSX,LDA) OP(BE,ABSY,LDX) OP(BF,ABSY,LAX)
+    OP(C0,IMM,CPY) OP(C1,INDX,CMP) OP(C2,IMM,NOP) OP(C3,INDX,DCP) OP(C4,ZP,CPY) OP(C5,ZP,CMP) OP(C6,ZP,DEC) OP(C7,ZP,DCP)
+    OP(C8,IMP,INY) OP(C9,IMM,CMP) OP(CA,IMP,DEX) OP(CB,IMM,SBX) OP(CC,ABS,CPY) OP(CD,ABS,CMP) OP(CE,ABS,DEC) OP(CF,ABS,DCP)
+    OP(D0,REL,BNE) OP(D1,INDY,CMP) OP(D2,IMP,JAM) OP(D3,INDY,DCP) OP(D4,ZPX,NOP) OP(D5,ZPX,CMP) OP(D6,ZPX,DEC) OP(D7,ZPX,DCP)
+    OP(D8,IMP,CLD) OP(D9,ABSY,CMP) OP(DA,IMP,NOP) OP(DB,ABSY,DCP) OP(DC,ABSX,NOP) OP(DD,ABSX,CMP) OP(DE,ABSX,DEC) OP(DF,ABSX,DCP)
+    OP(E0,IMM,CPX) OP(E1,INDX,SBC) OP(E2,IMM,NOP) OP(E3,INDX,ISC) OP(E4,ZP,CPX) OP(E5,ZP,SBC) OP(E6,ZP,INC) OP(E7,ZP,ISC)
+    OP(E8,IMP,INX) OP(E9,IMM,SBC) OP(EA,IMP,NOP) OP(EB,IMM,SBC) OP(EC,ABS,CPX) OP(ED,ABS,SBC) OP(EE,ABS,INC) OP(EF,ABS,ISC)
+    OP(F0,REL,BEQ) OP(F1,INDY,SBC) OP(F2,IMP,JAM) OP(F3,INDY,ISC) OP(F4,ZPX,NOP) OP(F5,ZPX,SBC) OP(F6,ZPX,INC) OP(F7,ZPX,ISC)
+    OP(F8,IMP,SED) OP(F9,ABSY,SBC) OP(FA,IMP,NOP) OP(FB,ABSY,ISC) OP(FC,ABSX,NOP) OP(FD,ABSX,SBC) OP(FE,ABSX,INC) OP(FF,ABSX,ISC)
+    }
+
+    return ticks;
+}
+
+#undef OP
+
+void init6502(cpu6502_t *cpu, read6502_t read, write6502_t write, void *context) {
+    memset(cpu, 0, sizeof(*cpu));
+    cpu->read = read;
+    cpu->write = write;
+    cpu->context = context;
+}
+
+int nmi6502(cpu6502_t *cpu) {
+    push16(cpu, cpu->pc);
+    push8(cpu, getP(cpu));
+    cpu->i = 1;
+    cpu->pc = read6502word(cpu, 0xfffa);
     return 7;
 }
 
-int reset6502() {
-    PC = read6502word(0xfffc);
-    A = X = Y = C = Z = I = D = V = N = 0;
-    SP = 0xFD;
+int reset6502(cpu6502_t *cpu) {
+    cpu->pc = read6502word(cpu, 0xfffc);
+    cpu->a = cpu->x = cpu->y = 0;
+    cpu->c = cpu->z = cpu->i = cpu->d = cpu->v = cpu->n = 0;
+    cpu->sp = 0xFD;
     return 7;
 }
 
-int irq6502() {
-    push16(PC);
-    push8(getP());
-    I = 1;
-    PC = read6502word(0xfffe);
+int irq6502(cpu6502_t *cpu) {
+    push16(cpu, cpu->pc);
+    push8(cpu, getP(cpu));
+    cpu->i = 1;
+    cpu->pc = read6502word(cpu, 0xfffe);
     return 7;
 }
 
-int step6502() {
-    opcode = read6502(PC++);
+int step6502_tables(cpu6502_t *cpu) {
+    uint8_t op = rd(cpu, cpu->pc++);
+    cpu->opcode = op;
+
+    cpu->penaltyop = 0;
+    cpu->penaltyaddr = 0;
+    cpu->clockticks = ticktable[op];
+
+    (*addrtable[op])(cpu);
+    (*optable[op])(cpu);
+
+    if (cpu->penaltyop && cpu->penaltyaddr) cpu->clockticks++;
+    return cpu->clockticks;
+}
 
-    penaltyop = 0;
-    penaltyaddr = 0;
-    clockticks6502 = ticktable[opcode];
+int step6502_fused(cpu6502_t *cpu) {
+    regs_t r;
+    regs_load(&r, cpu);
+    uint32_t ticks = fused_exec(cpu, &r);
+    regs_store(cpu, &r);
+    return ticks;
+}
+
+// ------------------ Traps ---------------------------------------------------
+
+int trap6502(cpu6502_t *cpu, uint16_t pc, trap6502_t handler) {
+    for (int i = 0; i < cpu->num_traps; i++) {
+        if (cpu->traps[i].pc != pc) continue;
+        if (handler) { cpu->traps[i].handler = handler; return 1; }
+        cpu->traps[i] = cpu->traps[--cpu->num_traps];
+        cpu->trap_pages[pc >> 8]--;
+        return 1;
+    }
+    if (!handler) return 1;
+    if (cpu->num_traps == MAX_TRAPS6502) return 0;
+    cpu->traps[cpu->num_traps].pc = pc;
+    cpu->traps[cpu->num_traps].handler = handler;
+    cpu->num_traps++;
+    cpu->trap_pages[pc >> 8]++;
+    return 1;
+}
 
-    (*addrtable[opcode])();
-    (*optable[opcode])();
+static inline trap6502_t find_trap(const cpu6502_t *cpu, uint16_t pc) {
+    if (!cpu->trap_pages[pc >> 8]) return NULL;
+    for (int i = 0; i < cpu->num_traps; i++)
+        if (cpu->traps[i].pc == pc) return cpu->traps[i].handler;
+    return NULL;
+}
+
+// Run the trap at PC, if there is one and it takes the call
+static inline uint32_t run_trap(cpu6502_t *cpu) {
+    trap6502_t handler = find_trap(cpu, cpu->pc);
+    return handler ? handler(cpu) : 0;
+}
+
+// ------------------ Profile and trace ---------------------------------------
+
+// Every instruction (or trap) step6502() and run6502() execute is passed to
+// profile6502() in a -DFAKE6502_PROFILE build, and to trace6502() with the
+// registers it left in a -DFAKE6502_TRACE one; otherwise these are nothing
+
+#ifdef FAKE6502_PROFILE
+#define PROFILE(pc, ticks) profile6502(cpu, pc, ticks)
+#else
+#define PROFILE(pc, ticks) ((void)(pc))
+#endif
+
+#ifdef FAKE6502_TRACE
+#define TRACE(pc, a, x, y, sp, p, ticks) trace6502(cpu, pc, a, x, y, sp, p, ticks)
+#else
+#define TRACE(pc, a, x, y, sp, p, ticks)
+#endif
+
+// ------------------ Breakpoints ---------------------------------------------
+
+// Only in a -DFAKE6502_DEBUG build, and only run6502() looks at them: the
+// page count is checked before each opcode fetch, the bitmap only on pages
+// that have a breakpoint
+
+#ifdef FAKE6502_DEBUG
+int is_breakpoint6502(const cpu6502_t *cpu, uint16_t pc) {
+    return cpu->bp_bits[pc >> 3] >> (pc & 7) & 1;
+}
+
+int breakpoint6502(cpu6502_t *cpu, uint16_t pc, int set) {
+    if (is_breakpoint6502(cpu, pc) == !!set) return 0;
+    cpu->bp_bits[pc >> 3] ^= 1 << (pc & 7);
+    if (set) cpu->bp_pages[pc >> 8]++; else cpu->bp_pages[pc >> 8]--;
+    return 1;
+}
+
+#define BREAKPOINT(pc) (cpu->bp_pages[(pc) >> 8] && is_breakpoint6502(cpu, pc))
+#endif
+
+// ----------------------------------------------------------------------------
+
+int step6502(cpu6502_t *cpu) {
+    uint16_t pc = cpu->pc;
+    uint32_t ticks = run_trap(cpu);
+    if (!ticks) {
+#ifdef FAKE6502_TABLE_DISPATCH
+        ticks = step6502_tables(cpu);
+#else
+        ticks = step6502_fused(cpu);
+#endif
+    }
+    PROFILE(pc, ticks);
+    TRACE(pc, cpu->a, cpu->x, cpu->y, cpu->sp, getP(cpu), ticks);
+    return ticks;
+}
+
+void stop6502(cpu6502_t *cpu) { cpu->stop = true; }
+
+uint32_t run6502(cpu6502_t *cpu, uint32_t cycles) {
+    uint32_t done = 0, count = 0;
+    cpu->stop = false;
+    cpu->at_breakpoint = false;
+
+#ifdef FAKE6502_TABLE_DISPATCH
+    while (done < cycles) {
+        uint16_t pc = cpu->pc;
+#ifdef FAKE6502_DEBUG
+        if (BREAKPOINT(pc)) { cpu->at_breakpoint = true; break; }
+#endif
+        uint32_t ticks = run_trap(cpu);
+        if (!ticks) ticks = step6502_tables(cpu);
+        PROFILE(pc, ticks);
+        TRACE(pc, cpu->a, cpu->x, cpu->y, cpu->sp, getP(cpu), ticks);
+        done += ticks;
+        count++;
+        if (cpu->stop) break;
+    }
+#else
+    // Registers stay in locals for the whole batch and are only written back
+    // to `cpu` on exit and around trap handlers
+    regs_t r;
+    regs_load(&r, cpu);
+    while (done < cycles) {
+        uint16_t pc = r.pc;
+#ifdef FAKE6502_DEBUG
+        if (BREAKPOINT(pc)) { cpu->at_breakpoint = true; break; }
+#endif
+        trap6502_t handler = find_trap(cpu, pc);
+        uint32_t ticks = 0;
+        if (handler) {
+            regs_store(cpu, &r);
+            ticks = handler(cpu);
+            regs_load(&r, cpu);
+        }
+        if (!ticks) ticks = fused_exec(cpu, &r);
+        PROFILE(pc, ticks);
+        TRACE(pc, r.a, r.x, r.y, r.sp, f_getp(&r), ticks);
+        done += ticks;
+        count++;
+        if (cpu->stop) break;
+    }
+    regs_store(cpu, &r);
+#endif
 
-    if (penaltyop && penaltyaddr) clockticks6502++;
-    return clockticks6502;
+    cpu->instructions = count;
+    return done;
 }
@@ -0,0 +1,160 @@
+#include "fastload.h"
+#include "basic_loader.h"
+#include "emulator.h"
+#include <stdio.h>
+
+#define HEADER_SIZE 11 // flags .. crc32, after SOH and the magic byte
+
+static enum { WAIT_SOH, WAIT_MAGIC, HEADER, DATA, DISCARD } state = WAIT_SOH;
+static uint8_t header[HEADER_SIZE];
+static uint8_t data[FASTLOAD_MAX_BLOCK];
+static uint32_t received = 0;
+static uint32_t start_ms = 0;
+static uint32_t last_ms = 0;
+static uint32_t crc;
+
+static struct
+{
+    uint16_t addr;
+    uint16_t len;
+    uint16_t entry;
+    uint8_t flags;
+    uint32_t elapsed_ms; // From SOH to the last data byte
+} block;
+
+uint32_t fastload_crc32(const uint8_t *buf, uint32_t len)
+{
+    uint32_t c = 0xFFFFFFFF;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        c ^= buf[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            c = (c >> 1) ^ (0xEDB88320 & -(c & 1));
+        }
+    }
+    return ~c;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+fastload_status_t fastload_feed(uint8_t byte, uint32_t now_ms)
+{
+    // A sender that went away mid-frame leaves us back in key mode
+    if (state != WAIT_SOH && now_ms - last_ms > FASTLOAD_TIMEOUT_MS)
+    {
+        state = WAIT_SOH;
+    }
+    last_ms = now_ms;
+
+    switch (state)
+    {
+    case WAIT_SOH:
+        if (byte != FASTLOAD_SOH)
+        {
+            return FASTLOAD_IDLE;
+        }
+        start_ms = now_ms;
+        state = WAIT_MAGIC;
+        return FASTLOAD_BUSY;
+
+    case WAIT_MAGIC:
+        // A stray Ctrl+A is dropped; whatever follows is a key again
+        if (byte != FASTLOAD_MAGIC)
+        {
+            state = WAIT_SOH;
+            return FASTLOAD_IDLE;
+        }
+        received = 0;
+        state = HEADER;
+        return FASTLOAD_BUSY;
+
+    case HEADER:
+        header[received++] = byte;
+        if (received < HEADER_SIZE)
+        {
+            return FASTLOAD_BUSY;
+        }
+
+        block.flags = header[0];
+        block.addr = get16(header + 1);
+        block.len = get16(header + 3);
+        block.entry = get16(header + 5);
+        crc = get16(header + 7) | (uint32_t)get16(header + 9) << 16;
+        if (block.len == 0 || block.len > FASTLOAD_MAX_BLOCK)
+        {
+            // Don't type the data in as keys; wait for the sender to stop
+            state = DISCARD;
+            return FASTLOAD_ERROR;
+        }
+        received = 0;
+        state = DATA;
+        return FASTLOAD_BUSY;
+
+    case DATA:
+        data[received++] = byte;
+        if (received < block.len)
+        {
+            return FASTLOAD_BUSY;
+        }
+
+        state = WAIT_SOH;
+        block.elapsed_ms = now_ms - start_ms;
+        return fastload_crc32(data, block.len) == crc ? FASTLOAD_BLOCK : FASTLOAD_ERROR;
+
+    case DISCARD:
+        return FASTLOAD_BUSY;
+    }
+    return FASTLOAD_IDLE;
+}
+
+static uint8_t apply_basic(apple1_t *m, char *report, uint32_t size)
+{
+    basic_load_result_t r;
+    int ok = basic_load(m, (const char *)data, block.len, block.flags & FASTLOAD_NEW, &r);
+
+    int n = snprintf(report, size, "\n[BASIC %lu lines, program $%04X-$%04X, %lu cycles",
+                     (unsigned long)r.lines, r.program_start, (r.program_end - 1) & 0xFFFF,
+                     (unsigned long)r.cycles);
+    if (r.errors && n < (int)size)
+    {
+        n += snprintf(report + n, size - n, ", %lu rejected (%s)", (unsigned long)r.errors,
+                      r.first_error);
+    }
+    if (n < (int)size)
+    {
+        snprintf(report + n, size - n, ok ? "]\n" : ", BASIC not responding]\n");
+    }
+    return ok ? FASTLOAD_ACK : FASTLOAD_NAK;
+}
+
+uint8_t fastload_apply(apple1_t *m, char *report, uint32_t size)
+{
+    if (block.flags & FASTLOAD_BASIC)
+    {
+        return apply_basic(m, report, size);
+    }
+
+    uint16_t last = (block.addr + block.len - 1) & 0xFFFF;
+    if (!emulator_load(m, block.addr, data, block.len))
+    {
+        snprintf(report, size, "\n[LOAD $%04X-$%04X rejected: outside RAM]\n", block.addr, last);
+        return FASTLOAD_NAK;
+    }
+
+    int n = snprintf(report, size, "\n[LOAD $%04X-$%04X, %u bytes in %lu ms, %lu bytes/s]\n",
+                     block.addr, last, block.len, (unsigned long)block.elapsed_ms,
+                     (unsigned long)(block.elapsed_ms ? block.len * 1000UL / block.elapsed_ms : 0));
+    if (block.flags & FASTLOAD_RUN)
+    {
+        emulator_run_from(m, block.entry);
+        if (n < (int)size)
+        {
+            snprintf(report + n, size - n, "[RUN $%04X]\n", block.entry);
+        }
+    }
+    return FASTLOAD_ACK;
+}
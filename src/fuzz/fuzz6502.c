@@ -0,0 +1,424 @@
+// Differential fuzzer for the 6502 engines (the native-fuzz environment).
+//
+// Runs one instruction at a time from random states on the reference
+// table-driven engine, step6502_tables(), and on `candidate`, and compares
+// the registers, getP(), the cycles returned and every bus access (address,
+// value, read or write, in order). Opcodes are taken in turn, so all 256 get
+// the same number of cases; registers and operands lean towards edge values
+// (00, 01, 7F, 80, FE, FF) so decimal mode, the JMP ($xxFF) wrap and the
+// page-crossing quirks of the undocumented opcodes come up often.
+//
+// The work is spread over forked processes, each with a 6502 of its own
+// whose page map is left all NULL, so every access goes through the bus
+// callbacks. A failing case is shrunk to a
+// minimal one (fewest memory bytes, registers and flags cleared where that
+// keeps it failing) and printed.
+//
+//   program [cases] [seed] [jobs]
+
+#include "fake6502.h"
+#include "disasm6502.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_CASES (1u << 24)
+#define MAX_CELLS 16    // Memory bytes a case can set explicitly
+#define MAX_ACCESSES 16 // Bus accesses logged per instruction (BRK takes 7)
+
+// The engine under test; point this at a new one
+static int (*const candidate)(cpu6502_t *cpu) = step6502_fused;
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t value;
+} cell_t;
+
+// One instruction's starting state. Memory is `fill` hashed with the
+// address (all zero if fill is 0), overridden by `cell` and by the opcode at
+// PC.
+typedef struct
+{
+    uint8_t opcode;
+    uint16_t pc;
+    uint8_t a, x, y, sp, p;
+    uint64_t fill;
+    uint32_t cells;
+    cell_t cell[MAX_CELLS];
+} case_t;
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t value;
+    uint8_t write;
+} access_t;
+
+typedef struct
+{
+    uint16_t pc;
+    uint8_t a, x, y, sp, p;
+    int ticks;
+    uint32_t accesses; // May exceed MAX_ACCESSES; only that many are kept
+    access_t access[MAX_ACCESSES];
+} result_t;
+
+// What the bus callbacks serve: the case being run and where its accesses
+// are logged
+typedef struct
+{
+    const case_t *current;
+    result_t *log;
+} bus_t;
+
+static cpu6502_t cpu;
+static bus_t bus;
+
+static uint64_t splitmix(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint8_t fill_byte(uint64_t fill, uint16_t address)
+{
+    uint64_t state = fill ^ (uint64_t)address << 32;
+    return splitmix(&state);
+}
+
+static uint8_t memory_at(const case_t *c, uint16_t address)
+{
+    if (address == c->pc)
+    {
+        return c->opcode;
+    }
+    for (uint32_t i = 0; i < c->cells; i++)
+    {
+        if (c->cell[i].address == address)
+        {
+            return c->cell[i].value;
+        }
+    }
+    return c->fill ? fill_byte(c->fill, address) : 0;
+}
+
+static void log_access(result_t *log, uint16_t address, uint8_t value, int write)
+{
+    if (log->accesses < MAX_ACCESSES)
+    {
+        log->access[log->accesses] = (access_t){address, value, write};
+    }
+    log->accesses++;
+}
+
+// A read sees the instruction's own earlier writes
+static uint8_t bus_read(void *context, uint16_t address)
+{
+    bus_t *b = context;
+    uint8_t value = memory_at(b->current, address);
+    uint32_t n = b->log->accesses < MAX_ACCESSES ? b->log->accesses : MAX_ACCESSES;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (b->log->access[i].write && b->log->access[i].address == address)
+        {
+            value = b->log->access[i].value;
+        }
+    }
+    log_access(b->log, address, value, 0);
+    return value;
+}
+
+static void bus_write(void *context, uint16_t address, uint8_t value)
+{
+    bus_t *b = context;
+    log_access(b->log, address, value, 1);
+}
+
+static void run(const case_t *c, int (*engine)(cpu6502_t *cpu), result_t *r)
+{
+    bus.current = c;
+    bus.log = r;
+    r->accesses = 0;
+    cpu.pc = c->pc;
+    cpu.a = c->a;
+    cpu.x = c->x;
+    cpu.y = c->y;
+    cpu.sp = c->sp;
+    setP(&cpu, c->p);
+    r->ticks = engine(&cpu);
+    r->pc = cpu.pc;
+    r->a = cpu.a;
+    r->x = cpu.x;
+    r->y = cpu.y;
+    r->sp = cpu.sp;
+    r->p = getP(&cpu);
+}
+
+static int same(const result_t *r1, const result_t *r2)
+{
+    if (r1->pc != r2->pc || r1->a != r2->a || r1->x != r2->x || r1->y != r2->y ||
+        r1->sp != r2->sp || r1->p != r2->p || r1->ticks != r2->ticks ||
+        r1->accesses != r2->accesses)
+    {
+        return 0;
+    }
+    uint32_t n = r1->accesses < MAX_ACCESSES ? r1->accesses : MAX_ACCESSES;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const access_t *a1 = &r1->access[i], *a2 = &r2->access[i];
+        if (a1->address != a2->address || a1->value != a2->value || a1->write != a2->write)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int fails(const case_t *c)
+{
+    result_t r1, r2;
+    run(c, step6502_tables, &r1);
+    run(c, candidate, &r2);
+    return !same(&r1, &r2);
+}
+
+static uint8_t edge_byte(uint64_t *state)
+{
+    static const uint8_t edges[] = {0x00, 0x01, 0x7F, 0x80, 0xFE, 0xFF};
+    uint64_t r = splitmix(state);
+    return (r & 3) == 0 ? edges[(r >> 8) % sizeof(edges)] : (uint8_t)(r >> 16);
+}
+
+// Case `index` of the run with `seed`; the opcode is index mod 256
+static void generate(uint64_t seed, uint64_t index, case_t *c)
+{
+    uint64_t state = seed ^ index * 0xD1B54A32D192ED03ull;
+    c->opcode = index;
+    c->pc = splitmix(&state);
+    if ((splitmix(&state) & 7) == 0)
+    {
+        c->pc |= 0xFD; // Operands across a page boundary
+    }
+    c->a = edge_byte(&state);
+    c->x = edge_byte(&state);
+    c->y = edge_byte(&state);
+    c->sp = edge_byte(&state);
+    c->p = splitmix(&state);
+    c->fill = splitmix(&state) | 1;
+
+    // Operand bytes, and the pointer a ($zp) or ($abs) operand might name
+    c->cells = 2;
+    c->cell[0] = (cell_t){(uint16_t)(c->pc + 1), edge_byte(&state)};
+    c->cell[1] = (cell_t){(uint16_t)(c->pc + 2), edge_byte(&state)};
+}
+
+// Replace the hashed fill with the bytes the reference engine actually
+// read, so shrinking can work on them one at a time
+static void make_explicit(case_t *c)
+{
+    result_t r;
+    run(c, step6502_tables, &r);
+    case_t e = *c;
+    e.fill = 0;
+    e.cells = 0;
+    uint32_t n = r.accesses < MAX_ACCESSES ? r.accesses : MAX_ACCESSES;
+    for (uint32_t i = 0; i < n && e.cells < MAX_CELLS; i++)
+    {
+        uint16_t address = r.access[i].address;
+        int known = address == c->pc;
+        for (uint32_t j = 0; j < e.cells; j++)
+        {
+            known |= e.cell[j].address == address;
+        }
+        if (!known && !r.access[i].write)
+        {
+            e.cell[e.cells++] = (cell_t){address, memory_at(c, address)};
+        }
+    }
+    if (fails(&e))
+    {
+        *c = e;
+    }
+}
+
+// Keep `*field = value` if the case still fails
+static int try_byte(case_t *c, uint8_t *field, uint8_t value)
+{
+    uint8_t old = *field;
+    if (old == value)
+    {
+        return 0;
+    }
+    *field = value;
+    if (fails(c))
+    {
+        return 1;
+    }
+    *field = old;
+    return 0;
+}
+
+static void shrink(case_t *c)
+{
+    make_explicit(c);
+    int progress = 1;
+    while (progress)
+    {
+        progress = 0;
+        for (uint32_t i = 0; i < c->cells; i++)
+        {
+            case_t t = *c;
+            t.cell[i] = t.cell[--t.cells];
+            if (fails(&t))
+            {
+                *c = t;
+                progress = 1;
+                break;
+            }
+            progress |= try_byte(c, &c->cell[i].value, 0);
+        }
+        progress |= try_byte(c, &c->a, 0);
+        progress |= try_byte(c, &c->x, 0);
+        progress |= try_byte(c, &c->y, 0);
+        progress |= try_byte(c, &c->sp, 0xFF);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            progress |= try_byte(c, &c->p, c->p & ~(1 << bit));
+        }
+    }
+}
+
+static void print_result(const char *name, const result_t *r)
+{
+    printf("  %-7s PC=%04X A=%02X X=%02X Y=%02X SP=%02X P=%02X cycles=%d bus:", name, r->pc,
+           r->a, r->x, r->y, r->sp, r->p, r->ticks);
+    uint32_t n = r->accesses < MAX_ACCESSES ? r->accesses : MAX_ACCESSES;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        printf(" %c%04X=%02X", r->access[i].write ? 'W' : 'R', r->access[i].address,
+               r->access[i].value);
+    }
+    printf(r->accesses > n ? " ...\n" : "\n");
+}
+
+static void report(const case_t *c)
+{
+    uint8_t bytes[3] = {c->opcode, memory_at(c, c->pc + 1), memory_at(c, c->pc + 2)};
+    char text[24];
+    disasm6502(c->pc, bytes, text, sizeof(text));
+    printf("Mismatch on $%02X %s at PC=%04X with A=%02X X=%02X Y=%02X SP=%02X P=%02X\n",
+           c->opcode, text, c->pc, c->a, c->x, c->y, c->sp, c->p);
+    printf("  memory:");
+    if (c->fill)
+    {
+        printf(" filled from %016llx,", (unsigned long long)c->fill);
+    }
+    for (uint32_t i = 0; i < c->cells; i++)
+    {
+        printf(" %04X=%02X", c->cell[i].address, c->cell[i].value);
+    }
+    printf(c->fill ? "\n" : " (the rest 00)\n");
+
+    result_t r1, r2;
+    run(c, step6502_tables, &r1);
+    run(c, candidate, &r2);
+    print_result("tables", &r1);
+    print_result("fused", &r2);
+}
+
+// One forked worker: cases job, job + jobs, ... Writes the first failing
+// case to `fd`.
+static int worker(uint64_t seed, uint64_t cases, int job, int jobs, int fd)
+{
+    case_t c;
+    for (uint64_t i = job; i < cases; i += jobs)
+    {
+        generate(seed, i, &c);
+        if (fails(&c))
+        {
+            return write(fd, &c, sizeof(c)) == sizeof(c) ? 1 : 2;
+        }
+    }
+    return 0;
+}
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t cases = argc > 1 ? strtoull(argv[1], NULL, 0) : DEFAULT_CASES;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : (uint64_t)time(NULL);
+    int jobs = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs < 1)
+    {
+        jobs = 1;
+    }
+
+    init6502(&cpu, bus_read, bus_write, &bus);
+
+    printf("fuzz: %llu cases, seed %llu, %d jobs\n", (unsigned long long)cases,
+           (unsigned long long)seed, jobs);
+    fflush(stdout);
+
+    double start = now_seconds();
+    pid_t pids[jobs];
+    int fds[jobs];
+    for (int j = 0; j < jobs; j++)
+    {
+        int pipefd[2];
+        if (pipe(pipefd) != 0)
+        {
+            perror("pipe");
+            return 2;
+        }
+        pids[j] = fork();
+        if (pids[j] == 0)
+        {
+            close(pipefd[0]);
+            _exit(worker(seed, cases, j, jobs, pipefd[1]));
+        }
+        close(pipefd[1]);
+        fds[j] = pipefd[0];
+    }
+
+    int failed = 0;
+    case_t c;
+    for (int j = 0; j < jobs; j++)
+    {
+        if (read(fds[j], &c, sizeof(c)) == sizeof(c) && !failed)
+        {
+            failed = 1;
+            for (int k = 0; k < jobs; k++)
+            {
+                if (k != j)
+                {
+                    kill(pids[k], SIGTERM);
+                }
+            }
+            shrink(&c);
+            report(&c);
+        }
+        close(fds[j]);
+        waitpid(pids[j], NULL, 0);
+    }
+    if (failed)
+    {
+        return 1;
+    }
+
+    double seconds = now_seconds() - start;
+    printf("fuzz: engines agree; %.2f s, %.1f M cases/s\n", seconds, cases / seconds / 1e6);
+    return 0;
+}
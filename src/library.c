@@ -0,0 +1,180 @@
+#include "library.h"
+#include "library_blob.h"
+#include "emulator.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LIBRARY_COUNT (sizeof(library_entries) / sizeof(library_entries[0]))
+
+uint32_t library_count()
+{
+    return LIBRARY_COUNT;
+}
+
+const library_entry_t *library_entry(uint32_t index)
+{
+    return index < LIBRARY_COUNT ? &library_entries[index] : NULL;
+}
+
+int library_find(const char *name)
+{
+    for (uint32_t i = 0; i < LIBRARY_COUNT; i++)
+    {
+        if (strcmp(library_entries[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// LZ4 length: the 4-bit field, plus bytes of 255 and a final byte when it
+// is 15
+static uint32_t lz4_length(uint32_t n, const uint8_t **src, const uint8_t *end)
+{
+    if (n == 15)
+    {
+        uint8_t b;
+        do
+        {
+            b = *src < end ? *(*src)++ : 0;
+            n += b;
+        } while (b == 255);
+    }
+    return n;
+}
+
+// Unpack one LZ4 block to `address` in m's RAM, or in `image` (a copy of RAM)
+// if that isn't NULL. Matches copy from what has already been unpacked, so
+// the destination itself is the window and no buffer is needed. Returns the
+// bytes written, stopping at `len`.
+static uint32_t unpack(apple1_t *m, const uint8_t *src, uint32_t packed, uint8_t *image,
+                       uint16_t address, uint32_t len)
+{
+    const uint8_t *end = src + packed;
+    uint32_t out = 0;
+
+    while (src < end)
+    {
+        uint8_t token = *src++;
+        uint32_t literals = lz4_length(token >> 4, &src, end);
+        if (literals > (uint32_t)(end - src) || out + literals > len)
+        {
+            return out;
+        }
+        while (literals--)
+        {
+            uint8_t b = *src++;
+            if (image)
+            {
+                image[address + out++] = b;
+            }
+            else
+            {
+                write_memory(m, address + out++, b);
+            }
+        }
+        if (src == end)
+        {
+            break; // The last sequence has literals only
+        }
+
+        uint32_t offset = src[0] | src[1] << 8;
+        src += 2;
+        uint32_t match = lz4_length(token & 15, &src, end) + 4;
+        if (offset == 0 || offset > out || out + match > len)
+        {
+            return out;
+        }
+        while (match--)
+        {
+            uint16_t a = address + out++;
+            if (image)
+            {
+                image[a] = image[a - offset];
+            }
+            else
+            {
+                write_memory(m, a, read_memory(m, a - offset));
+            }
+        }
+    }
+    return out;
+}
+
+static int32_t load(apple1_t *m, uint32_t index, uint8_t *image)
+{
+    const library_entry_t *e = library_entry(index);
+    if (!e)
+    {
+        return -1;
+    }
+
+    const library_segment_t *seg = &library_segments[e->first_segment];
+    for (int i = 0; i < e->segments; i++)
+    {
+        if ((uint32_t)seg[i].address + seg[i].len > emulator_ram_size())
+        {
+            return -1;
+        }
+    }
+
+    int32_t total = 0;
+    for (int i = 0; i < e->segments; i++)
+    {
+        if (unpack(m, library_blob + seg[i].offset, seg[i].packed, image, seg[i].address,
+                   seg[i].len) != seg[i].len)
+        {
+            return -1;
+        }
+        total += seg[i].len;
+    }
+    return total;
+}
+
+int32_t library_load(apple1_t *m, uint32_t index)
+{
+    return load(m, index, NULL);
+}
+
+void library_load_boot(apple1_t *m, int verbose)
+{
+    for (uint32_t i = 0; i < LIBRARY_COUNT; i++)
+    {
+        const library_entry_t *e = &library_entries[i];
+        if (!(e->flags & LIBRARY_BOOT))
+        {
+            continue;
+        }
+        int32_t len = library_load(m, i);
+        if (!verbose)
+        {
+            continue;
+        }
+        if (len < 0)
+        {
+            printf("%s doesn't fit in RAM\n", e->title);
+            continue;
+        }
+        printf("%s loaded at $%04X (%ld bytes)\n", e->title,
+               library_segments[e->first_segment].address, (long)len);
+        printf("To run it, type: %XR\n", e->entry);
+    }
+}
+
+void library_boot_image(uint8_t *image)
+{
+    memset(image, 0, emulator_ram_size());
+    for (uint32_t i = 0; i < LIBRARY_COUNT; i++)
+    {
+        if (library_entries[i].flags & LIBRARY_BOOT)
+        {
+            load(NULL, i, image);
+        }
+    }
+}
+
+uint32_t library_flash_size()
+{
+    return sizeof(library_blob) + sizeof(library_segments) + sizeof(library_entries);
+}
@@ -1,65 +1,779 @@
 #include <Arduino.h>
+#include "debugger.h"
 #include "display.h"
 #include "emulator.h"
+#include "fastload.h"
+#include "library.h"
+#include "pacing.h"
+#include "profile.h"
+#include "snapshot_littlefs.h"
+#include "spsc_queue.h"
+#include "trace.h"
+#include <ctype.h>
+#include <string.h>
 
-void setup()
+// Build with -DDUAL_CORE to run the 6502 in its own task on core 1 while a
+// task on core 0 handles the serial port and the TFT. Without it both sides
+// take turns in loop().
+//
+// -DDUAL_MACHINE runs two independent Apple-1s, each with its own RAM,
+// keyboard queue, pacing and terminal; with -DDUAL_CORE the first runs on
+// core 0 and the second on core 1. Serial input and the panel go to the
+// machine in focus, switched with Ctrl+W 1 or 2.
+#ifdef DUAL_MACHINE
+#define MACHINES 2
+#else
+#define MACHINES 1
+#endif
+
+// Requests from the serial side that have to run on the CPU side
+enum
 {
-    Serial.begin(57600);
+    CMD_NEXT_SPEED = 1,
+    CMD_SPEED_STATS,
+    CMD_LOAD,    // A fast-load block has arrived
+    CMD_LIBRARY, // Followed by the index of the library program to run
+    CMD_HOLD,    // Stay still until the serial side is done (dual-core)
+    CMD_RESUME,  // The machine was changed under the CPU side; carry on
+    CMD_PROFILE, // Print the execution profile (-DFAKE6502_PROFILE)
+    CMD_TRACE,   // Dump the instruction trace (-DFAKE6502_TRACE)
+};
 
-    display_init();
+// An Apple-1 and the CPU side state that goes with it
+typedef struct
+{
+    apple1_t *apple; // Created in setup()
+    int index;
+    char tag[4]; // " #1" in messages when there is more than one machine
 
-    // display_write_line("Apple-1 Emulator");
-    // display_write_line("Loading Wozmon...");
+    uint8_t cmd_storage[8];
+    spsc_queue_t cmd_queue;
+    pacing_t pacing;
 
-    Serial.println("Apple-1 Emulator");
-    Serial.println("Loading Wozmon...");
+    // The CPU is parked while the 6502 polls an empty keyboard: nothing is
+    // emulated until a key or command arrives, and the time is then counted
+    // as spent in the poll loop. Counters cover the window since the last
+    // report.
+    bool cpu_parked;
+    uint32_t park_start_us;
+    uint64_t parked_us;
+    uint32_t park_count;
 
-    reset_emulator();
+    // A reset is timed until Wozmon prints its prompt
+    bool reset_timing;
+    uint32_t reset_start_us;
+    uint32_t reset_us;    // In reset_emulator() itself
+    uint32_t reset_dirty; // RAM pages it had to clear
 
-    Serial.println("Ready");
+#ifdef DUAL_CORE
+    TaskHandle_t cpu_task_handle;
+
+    // Set by the serial side to hold the CPU side between slices, and by the
+    // CPU side while it is held
+    bool hold_requested;
+    bool cpu_held;
+#endif
+} machine_t;
+
+static machine_t machines[MACHINES];
+
+// The machine that gets the keys and is shown on the panel and serial
+static machine_t *focus = &machines[0];
+
+// Tell a parked CPU there is input (serial side)
+static void wake_cpu(machine_t *m)
+{
+#ifdef DUAL_CORE
+    if (m->cpu_task_handle)
+    {
+        xTaskNotifyGive(m->cpu_task_handle);
+    }
+#endif
 }
 
-void loop()
+static void print_pacing_stats(machine_t *m)
+{
+    pacing_stats_t st;
+    pacing_get_stats(&m->pacing, &st, micros());
+
+    double mhz = st.window_us ? (double)st.cycles / st.window_us : 0.0;
+    Serial.printf("\n[SPEED%s %s: %.3f MHz over %lu ms, drift %ld us (%ld..%ld), "
+                  "jitter %lu us, %lu slices, dropped %lu us]\n",
+                  m->tag, pacing_mode_name(pacing_get_mode(&m->pacing)), mhz,
+                  (unsigned long)(st.window_us / 1000), (long)st.drift_us,
+                  (long)st.drift_min_us, (long)st.drift_max_us,
+                  (unsigned long)st.jitter_us, (unsigned long)st.slices,
+                  (unsigned long)st.dropped_us);
+
+    uint32_t now = micros();
+    uint64_t idle_us = m->parked_us + (m->cpu_parked ? now - m->park_start_us : 0);
+    Serial.printf("[IDLE%s parked %lu ms (%lu%%), %lu times]\n", m->tag,
+                  (unsigned long)(idle_us / 1000),
+                  (unsigned long)(st.window_us ? idle_us * 100 / st.window_us : 0),
+                  (unsigned long)m->park_count);
+    m->parked_us = 0;
+    m->park_count = 0;
+    m->park_start_us = now;
+}
+
+// ---- CPU side ----
+
+static void report_reset_time(machine_t *m)
+{
+    uint32_t cycles = emulator_cycles_to_prompt(m->apple);
+    if (!m->reset_timing || cycles == 0)
+    {
+        return;
+    }
+    m->reset_timing = false;
+    Serial.printf("\n[RESET%s %lu dirty pages cleared in %lu us, prompt after %lu us, "
+                  "%lu cycles]\n",
+                  m->tag, (unsigned long)m->reset_dirty, (unsigned long)m->reset_us,
+                  (unsigned long)(micros() - m->reset_start_us), (unsigned long)cycles);
+}
+
+// Put a received fast-load block into RAM and answer the sender, which waits
+// for the ACK before it sends the next block
+static void apply_load(machine_t *m)
+{
+    char report[128];
+    uint8_t reply = fastload_apply(m->apple, report, sizeof(report));
+    Serial.print(report);
+    Serial.write(reply);
+}
+
+// Unpack a program from the software library into RAM and start it
+static void run_from_library(machine_t *m, uint8_t index)
+{
+    const library_entry_t *e = library_entry(index);
+    uint32_t start = micros();
+    int32_t len = library_load(m->apple, index);
+    if (len < 0)
+    {
+        Serial.printf("\n[LIBRARY%s %s doesn't fit in RAM]\n", m->tag, e->title);
+        return;
+    }
+    Serial.printf("\n[LIBRARY%s %s: %ld bytes in %lu us, RUN $%04X]\n", m->tag, e->title,
+                  (long)len, (unsigned long)(micros() - start), e->entry);
+    emulator_run_from(m->apple, e->entry);
+}
+
+// Run requests from the serial side; returns true if there were any
+static bool process_commands(machine_t *m)
+{
+    bool any = false;
+    uint8_t cmd;
+    while (spsc_pop(&m->cmd_queue, &cmd))
+    {
+        any = true;
+        switch (cmd)
+        {
+        case CMD_NEXT_SPEED:
+            print_pacing_stats(m);
+            pacing_set_mode(&m->pacing,
+                            (pacing_mode_t)((pacing_get_mode(&m->pacing) + 1) % PACING_MODE_COUNT),
+                            micros());
+            Serial.printf("[SPEED%s %s]\n", m->tag, pacing_mode_name(pacing_get_mode(&m->pacing)));
+            break;
+
+        case CMD_SPEED_STATS:
+            print_pacing_stats(m);
+            break;
+
+        case CMD_LOAD:
+            apply_load(m);
+            break;
+
+#ifdef DUAL_CORE
+        case CMD_HOLD:
+            __atomic_store_n(&m->cpu_held, true, __ATOMIC_RELEASE);
+            while (__atomic_load_n(&m->hold_requested, __ATOMIC_ACQUIRE))
+            {
+                vTaskDelay(1);
+            }
+            __atomic_store_n(&m->cpu_held, false, __ATOMIC_RELEASE);
+            break;
+#endif
+
+        case CMD_RESUME:
+            // Don't try to catch up on the time it was held
+            pacing_set_mode(&m->pacing, pacing_get_mode(&m->pacing), micros());
+            break;
+
+        case CMD_LIBRARY:
+            if (spsc_pop(&m->cmd_queue, &cmd))
+            {
+                run_from_library(m, cmd);
+            }
+            break;
+
+#ifdef FAKE6502_PROFILE
+        case CMD_PROFILE:
+            profile_print(m->apple);
+            break;
+#endif
+
+#ifdef FAKE6502_TRACE
+        case CMD_TRACE:
+            trace_print(m->apple);
+            break;
+#endif
+        }
+    }
+    return any;
+}
+
+// Run the cycles owed to the pacing schedule. Returns false when there was
+// nothing to do and the caller can sleep.
+static bool run_cpu_slice(machine_t *m)
+{
+    bool commands = process_commands(m);
+
+    if (m->cpu_parked)
+    {
+        if (!emulator_key_pending(m->apple) && !commands)
+        {
+            return false;
+        }
+
+        uint32_t now = micros();
+        m->parked_us += now - m->park_start_us;
+        m->cpu_parked = false;
+        pacing_fast_forward(&m->pacing, now);
+    }
+
+    // run_emulator() returns early once the 6502 is sitting in a key-wait
+    // loop or spinning on the display's busy bit; it would have spent the
+    // rest of the slice polling, so charge the slice in full.
+    uint32_t budget = pacing_budget(&m->pacing, micros());
+    if (budget == 0)
+    {
+        return false;
+    }
+
+    uint32_t ran = run_emulator(m->apple, budget);
+    if ((emulator_waiting_for_key(m->apple) || emulator_output_full(m->apple)) && ran < budget)
+    {
+        ran = budget;
+    }
+    pacing_account(&m->pacing, ran);
+    report_reset_time(m);
+
+    // Park on an empty keyboard poll rather than wake up for it every slice
+    if (emulator_waiting_for_key(m->apple) && !emulator_key_pending(m->apple))
+    {
+        m->cpu_parked = true;
+        m->park_start_us = micros();
+        m->park_count++;
+        return false;
+    }
+
+    // Let the display catch up if the output queue is full
+    return !emulator_output_full(m->apple);
+}
+
+// ---- Serial / display side ----
+
+// Software flow control for pasting long programs: XOFF once the key queue
+// is nearly full, XON again when the 6502 has worked it down
+#define XON 0x11
+#define XOFF 0x13
+#define KEY_XOFF_FREE 128 // Send XOFF with this much room left (UART slack)
+#define KEY_XON_FREE 512  // Send XON once this much room is free again
+
+static bool xoff_sent = false;
+static uint32_t xoff_count = 0;
+
+static void print_key_stats()
+{
+    key_queue_stats_t st;
+    emulator_get_key_stats(focus->apple, &st);
+    Serial.printf("\n[KEYS%s %lu/%lu queued, high water %lu, %lu dropped, %lu XOFF]\n",
+                  focus->tag, (unsigned long)st.queued, (unsigned long)st.capacity,
+                  (unsigned long)st.high_water, (unsigned long)st.overflows,
+                  (unsigned long)xoff_count);
+}
+
+static void update_flow_control()
+{
+    uint32_t room = emulator_key_queue_free(focus->apple);
+    if (!xoff_sent && room <= KEY_XOFF_FREE)
+    {
+        Serial.write(XOFF);
+        xoff_sent = true;
+        xoff_count++;
+    }
+    else if (xoff_sent && room >= KEY_XON_FREE)
+    {
+        Serial.write(XON);
+        xoff_sent = false;
+    }
+}
+
+// Snapshots are taken on the serial side, which owns the display. In the
+// dual-core build the CPU side is held between slices meanwhile; with one
+// core the two sides never run at once anyway. Each machine has its own
+// file.
+static const char *const snapshot_files[] = {"/apple1.snap", "/apple1-2.snap"};
+
+static bool hold_cpu(machine_t *m)
+{
+#ifdef DUAL_CORE
+    __atomic_store_n(&m->hold_requested, true, __ATOMIC_RELEASE);
+    if (!spsc_push(&m->cmd_queue, CMD_HOLD))
+    {
+        __atomic_store_n(&m->hold_requested, false, __ATOMIC_RELEASE);
+        return false;
+    }
+    wake_cpu(m);
+    while (!__atomic_load_n(&m->cpu_held, __ATOMIC_ACQUIRE))
+    {
+        vTaskDelay(1);
+    }
+#endif
+    return true;
+}
+
+static void release_cpu(machine_t *m)
+{
+#ifdef DUAL_CORE
+    __atomic_store_n(&m->hold_requested, false, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&m->cpu_held, __ATOMIC_ACQUIRE))
+    {
+        vTaskDelay(1);
+    }
+#endif
+    spsc_push(&m->cmd_queue, CMD_RESUME);
+    wake_cpu(m);
+}
+
+static void snapshot(machine_t *m, bool save)
+{
+    if (!hold_cpu(m))
+    {
+        Serial.println("\n[SNAPSHOT busy, try again]");
+        return;
+    }
+
+    // Output the 6502 has already written belongs on the saved screen
+    char c;
+    while (emulator_read_output(m->apple, &c))
+    {
+        display_terminal_write_char(m->index, c);
+    }
+
+    // The snapshot takes the screen of the terminal shown, which is the
+    // machine in focus
+    const char *file = snapshot_files[m->index];
+    uint32_t start = micros();
+    int32_t size = save ? snapshot_save(m->apple, &snapshot_littlefs_backend, file)
+                        : snapshot_restore(m->apple, &snapshot_littlefs_backend, file);
+    uint32_t elapsed = micros() - start;
+    release_cpu(m);
+
+    if (size < 0)
+    {
+        Serial.printf("\n[SNAPSHOT %s failed: %s]\n", save ? "save" : "restore",
+                      snapshot_error_name(size));
+        return;
+    }
+    Serial.printf("\n[SNAPSHOT %s %ld bytes in %lu us]\n", save ? "saved" : "restored",
+                  (long)size, (unsigned long)elapsed);
+}
+
+// With the CPU side held, or before it has started
+static void reset_machine(machine_t *m)
+{
+    m->reset_dirty = emulator_dirty_pages(m->apple);
+    m->reset_start_us = micros();
+    reset_emulator(m->apple);
+    m->reset_us = micros() - m->reset_start_us;
+    m->reset_timing = true;
+}
+
+// Resets are done here like snapshots, so that output the old program had
+// queued for the display can be dropped before the screen is cleared
+static void reset(machine_t *m)
+{
+    if (!hold_cpu(m))
+    {
+        Serial.println("\n[RESET busy, try again]");
+        return;
+    }
+    Serial.println("\n[RESET]");
+    reset_machine(m);
+
+    char c;
+    while (emulator_read_output(m->apple, &c))
+    {
+    }
+    display_clear();
+    release_cpu(m); // The CPU side starts the schedule afresh
+}
+
+// Ctrl+O lists the software library; the next key picks a program
+#define LIBRARY_KEYS "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+
+static bool library_menu_open = false;
+
+static void print_library_menu()
 {
-    // Check if data is available on serial
-    if (Serial.available() > 0)
+    uint32_t count = library_count();
+    if (count > sizeof(LIBRARY_KEYS) - 1)
     {
-        char incomingChar = Serial.read();
+        count = sizeof(LIBRARY_KEYS) - 1;
+    }
+    Serial.println("\n[LIBRARY]");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const library_entry_t *e = library_entry(i);
+        Serial.printf("  %c  %-32s $%04X\n", LIBRARY_KEYS[i], e->title, e->entry);
+    }
+    Serial.printf("Press %c-%c, or any other key to cancel\n", LIBRARY_KEYS[0],
+                  LIBRARY_KEYS[count - 1]);
+}
+
+static void pick_from_library(char key)
+{
+    library_menu_open = false;
+    const char *k = strchr(LIBRARY_KEYS, toupper(key));
+    if (key == 0 || !k || (uint32_t)(k - LIBRARY_KEYS) >= library_count())
+    {
+        Serial.println("[LIBRARY cancelled]");
+        return;
+    }
+    if (spsc_free(&focus->cmd_queue) < 2)
+    {
+        Serial.println("[LIBRARY busy, try again]");
+        return;
+    }
+    spsc_push(&focus->cmd_queue, CMD_LIBRARY);
+    spsc_push(&focus->cmd_queue, k - LIBRARY_KEYS);
+}
+
+// Ctrl+W is the machine prefix: the next key, 1 or 2, picks the machine that
+// gets the keyboard and is shown; a second Ctrl+W switches to the other one
+#define MACHINE_PREFIX 0x17
 
-        // Handle special control key combinations
-        if (incomingChar == 0x12) // Ctrl+R (0x12 = DC2)
+static bool machine_prefix = false;
+
+static void pick_machine(char key)
+{
+    machine_prefix = false;
+    int index = key == MACHINE_PREFIX ? (focus->index + 1) % MACHINES : key - '1';
+    if (index < 0 || index >= MACHINES)
+    {
+        Serial.println("[MACHINE cancelled]");
+        return;
+    }
+    focus = &machines[index];
+    display_show(index);
+    Serial.printf("\n[MACHINE %d]\n", index + 1);
+}
+
+#ifdef FAKE6502_DEBUG
+// While the debugger has the 6502 stopped, typing goes to it; command lines
+// run with the CPU side held
+static bool debugger_input(char c)
+{
+    bool line = c == '\r' || c == '\n';
+    if (!debugger_halted(focus->apple) || (c < ' ' && !line && c != 0x08))
+    {
+        return false; // Ctrl+R, Ctrl+P and the rest still work
+    }
+    if (line && !hold_cpu(focus))
+    {
+        Serial.println("\n[DEBUG busy, try again]");
+        return true;
+    }
+    debugger_key(c);
+    if (line)
+    {
+        release_cpu(focus);
+    }
+    return true;
+}
+#endif
+
+static void handle_input(char incomingChar)
+{
+    if (library_menu_open)
+    {
+        pick_from_library(incomingChar);
+        return;
+    }
+    if (machine_prefix)
+    {
+        pick_machine(incomingChar);
+        return;
+    }
+#ifdef FAKE6502_DEBUG
+    if (debugger_input(incomingChar))
+    {
+        return;
+    }
+#endif
+
+    // Handle special control key combinations
+    if (incomingChar == 0x12) // Ctrl+R (0x12 = DC2)
+    {
+        reset(focus);
+        return;
+    }
+    else if (incomingChar == 0x0C) // Ctrl+L (0x0C = Form Feed)
+    {
+        Serial.println("\n[CLEAR SCREEN]");
+        display_clear();
+        return;
+    }
+    else if (incomingChar == 0x14) // Ctrl+T: cycle 1.023 MHz / turbo / unthrottled
+    {
+        spsc_push(&focus->cmd_queue, CMD_NEXT_SPEED);
+        return;
+    }
+    else if (incomingChar == 0x02) // Ctrl+B: display renderer benchmark
+    {
+        display_benchmark();
+        return;
+    }
+    else if (incomingChar == 0x10) // Ctrl+P: pacing and keyboard stats
+    {
+        print_key_stats();
+        for (int i = 0; i < MACHINES; i++)
         {
-            Serial.println("\n[RESET]");
-            display_clear();
-            reset_emulator();
-            return;
+            spsc_push(&machines[i].cmd_queue, CMD_SPEED_STATS);
+            wake_cpu(&machines[i]);
         }
-        else if (incomingChar == 0x0C) // Ctrl+L (0x0C = Form Feed)
+        return;
+    }
+    else if (incomingChar == MACHINE_PREFIX) // Ctrl+W: switch machines
+    {
+#ifdef DUAL_MACHINE
+        machine_prefix = true;
+#else
+        Serial.println("\n[MACHINE not built in, build with -DDUAL_MACHINE]");
+#endif
+        return;
+    }
+    else if (incomingChar == 0x05) // Ctrl+E: execution profile
+    {
+#ifdef FAKE6502_PROFILE
+        spsc_push(&focus->cmd_queue, CMD_PROFILE);
+#else
+        Serial.println("\n[PROFILE not built in, build with -DFAKE6502_PROFILE]");
+#endif
+        return;
+    }
+    else if (incomingChar == 0x04) // Ctrl+D: stop in the debugger
+    {
+#ifdef FAKE6502_DEBUG
+        if (hold_cpu(focus))
         {
-            Serial.println("\n[CLEAR SCREEN]");
-            display_clear();
-            return;
+            debugger_break(focus->apple);
+            release_cpu(focus);
         }
+#else
+        Serial.println("\n[DEBUG not built in, build with -DFAKE6502_DEBUG]");
+#endif
+        return;
+    }
+    else if (incomingChar == 0x15) // Ctrl+U: instruction trace
+    {
+#ifdef FAKE6502_TRACE
+        spsc_push(&focus->cmd_queue, CMD_TRACE);
+#else
+        Serial.println("\n[TRACE not built in, build with -DFAKE6502_TRACE]");
+#endif
+        return;
+    }
+    else if (incomingChar == 0x0B) // Ctrl+K: save a snapshot
+    {
+        snapshot(focus, true);
+        return;
+    }
+    else if (incomingChar == 0x19) // Ctrl+Y: restore it
+    {
+        snapshot(focus, false);
+        return;
+    }
+    else if (incomingChar == 0x0F && library_count() > 0) // Ctrl+O: software library
+    {
+        print_library_menu();
+        library_menu_open = true;
+        return;
+    }
 
-        // Map modern backspace to Apple-1 backspace
-        if (incomingChar == 0x08 || incomingChar == 0x7F)
+    // Map modern backspace to Apple-1 backspace
+    if (incomingChar == 0x08 || incomingChar == 0x7F)
+    {
+        incomingChar = 0xDF; // Apple-1 backspace
+    }
+
+    // Queue key for emulator
+    emulator_queue_key(focus->apple, incomingChar);
+}
+
+static void service_io()
+{
+    // Take everything the UART has, as long as the key queue has room; the
+    // rest waits in the UART buffer until the 6502 catches up
+    bool input = false;
+    while (Serial.available() > 0 && emulator_key_queue_free(focus->apple) > 0)
+    {
+        char c = Serial.read();
+        switch (fastload_feed(c, millis()))
+        {
+        case FASTLOAD_IDLE:
+            handle_input(c);
+            break;
+
+        case FASTLOAD_BLOCK:
+            spsc_push(&focus->cmd_queue, CMD_LOAD);
+            break;
+
+        case FASTLOAD_ERROR:
+            Serial.println("\n[LOAD rejected: bad length or CRC]");
+            Serial.write(FASTLOAD_NAK);
+            break;
+
+        case FASTLOAD_BUSY:
+            break;
+        }
+        input = true;
+    }
+    if (input)
+    {
+        wake_cpu(focus);
+    }
+    update_flow_control();
+
+    // Take whatever each 6502 has written to DSP into its terminal's text
+    // model; the panel is redrawn once per frame however much arrived
+    for (int i = 0; i < MACHINES; i++)
+    {
+        char c;
+        while (emulator_read_output(machines[i].apple, &c))
+        {
+            display_terminal_write_char(i, c);
+        }
+    }
+    display_update();
+}
+
+#ifdef DUAL_CORE
+// A busy CPU task still sleeps for a tick this often, so the idle task on
+// its core gets to feed the task watchdog
+#define CPU_MAX_BUSY_MS 100
+
+static void cpu_task(void *arg)
+{
+    machine_t *m = (machine_t *)arg;
+    TickType_t last_sleep = xTaskGetTickCount();
+    for (;;)
+    {
+        if (!run_cpu_slice(m))
+        {
+            // While parked, block until serial input wakes us; the idle task
+            // then keeps the core in WAITI with its clock gated
+            ulTaskNotifyTake(pdTRUE, m->cpu_parked ? portMAX_DELAY : 1);
+            last_sleep = xTaskGetTickCount();
+        }
+        else if (xTaskGetTickCount() - last_sleep >= pdMS_TO_TICKS(CPU_MAX_BUSY_MS))
+        {
+            vTaskDelay(1);
+            last_sleep = xTaskGetTickCount();
+        }
+    }
+}
+
+static void io_task(void *)
+{
+    for (;;)
+    {
+        service_io();
+        vTaskDelay(1);
+    }
+}
+#endif
+
+void setup()
+{
+    Serial.setRxBufferSize(1024);
+    Serial.begin(57600);
+
+    display_init();
+
+    // display_write_line("Apple-1 Emulator");
+    // display_write_line("Loading Wozmon...");
+
+    Serial.println("Apple-1 Emulator");
+    Serial.println("Loading Wozmon...");
+
+    for (int i = 0; i < MACHINES; i++)
+    {
+        machine_t *m = &machines[i];
+        m->apple = emulator_create();
+        if (!m->apple)
+        {
+            Serial.println("No memory for the machine");
+            for (;;)
+            {
+                delay(1000);
+            }
+        }
+        m->index = i;
+        if (MACHINES > 1)
         {
-            incomingChar = 0xDF; // Apple-1 backspace
+            snprintf(m->tag, sizeof(m->tag), " #%c", '1' + i);
         }
+        spsc_queue_t queue = SPSC_QUEUE_INIT(m->cmd_storage);
+        m->cmd_queue = queue;
+        reset_machine(m);
+        pacing_init(&m->pacing, micros());
+    }
 
-        // Queue key for emulator
-        emulator_queue_key(incomingChar);
+    // DRAM budget
+    emulator_print_memory_report();
+    Serial.printf("Free heap: %u bytes (largest block %u), min free %u\n",
+                  ESP.getFreeHeap(), ESP.getMaxAllocHeap(), ESP.getMinFreeHeap());
+
+#ifdef DUAL_CORE
+    // One machine runs on core 1; with two, the first shares core 0 with the
+    // display and serial task
+    for (int i = 0; i < MACHINES; i++)
+    {
+        xTaskCreatePinnedToCore(cpu_task, "cpu6502", 4096, &machines[i], 1,
+                                &machines[i].cpu_task_handle, MACHINES == 1 ? 1 : i);
     }
+    xTaskCreatePinnedToCore(io_task, "io", 4096, NULL, 1, NULL, 0);
+#ifdef DUAL_MACHINE
+    Serial.println("Dual-machine: #1 on core 0, #2 on core 1, Ctrl+W 1/2 switches");
+#else
+    Serial.println("Dual-core: 6502 on core 1, display and serial on core 0");
+#endif
+#endif
 
-    // Run CPU instructions (multiple per loop for better performance)
-    for (int i = 0; i < 200; i++)
+    Serial.println("Ready");
+}
+
+void loop()
+{
+#ifdef DUAL_CORE
+    // Everything runs in cpu_task and io_task
+    vTaskDelete(NULL);
+#else
+    bool busy = false;
+    for (int i = 0; i < MACHINES; i++)
     {
-        step_emulator();
+        busy |= run_cpu_slice(&machines[i]);
     }
 
-    // Update the blinking cursor
-    display_update_cursor();
+    service_io();
 
-    // Small delay to prevent watchdog issues
-    delay(1);
+    // Sleep when ahead of schedule (also keeps the watchdog happy)
+    if (!busy)
+    {
+        delay(1);
+    }
+#endif
 }
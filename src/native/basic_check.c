@@ -0,0 +1,185 @@
+// Host check for the BASIC fast-loader:
+//
+//   .pio/build/native/program basic-check programs/*.bas
+//
+// and "basic-image file.bas", which prints the loaded program as a Wozmon
+// hex dump for the software library (programs/library.txt).
+
+#include "basic_check.h"
+#include "basic_loader.h"
+#include "emulator.h"
+#include "fake6502.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLICE 20000
+#define MAX_SLICES 100000
+
+// What the loader has to get right: BASIC's pointers, the program between
+// PP and HIMEM, and the (empty) variable space between LOMEM and PV
+typedef struct
+{
+    uint16_t lomem, himem, pp, pv;
+    uint8_t ram[0x10000];
+    uint64_t cycles;
+} image_t;
+
+static uint16_t peek16(apple1_t *m, uint16_t address)
+{
+    return read_memory(m, address) | read_memory(m, address + 1) << 8;
+}
+
+static void take_image(apple1_t *m, image_t *img)
+{
+    img->lomem = peek16(m, BASIC_LOMEM);
+    img->himem = peek16(m, BASIC_HIMEM);
+    img->pp = peek16(m, BASIC_PP);
+    img->pv = peek16(m, BASIC_PV);
+    for (uint32_t a = 0; a < 0x10000; a++)
+    {
+        img->ram[a] = read_memory(m, a);
+    }
+}
+
+static void drain_output(apple1_t *m)
+{
+    char c;
+    while (emulator_read_output(m, &c))
+    {
+    }
+}
+
+// Feed keys as fast as the 6502 takes them, then run until it waits again
+static uint64_t type_keys(apple1_t *m, const char *text, uint32_t len)
+{
+    uint64_t cycles = 0;
+    uint32_t i = 0;
+    for (int slices = 0; slices < MAX_SLICES; slices++)
+    {
+        while (i < len && emulator_key_queue_free(m) > 0)
+        {
+            emulator_queue_key(m, text[i++]);
+        }
+        cycles += run_emulator(m, SLICE);
+        drain_output(m);
+        if (i == len && emulator_waiting_for_key(m) && !emulator_key_pending(m))
+        {
+            break;
+        }
+    }
+    return cycles;
+}
+
+static int check_file(apple1_t *m, const char *path)
+{
+    static image_t typed, loaded;
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        perror(path);
+        return 1;
+    }
+    static char text[64 * 1024];
+    uint32_t len = fread(text, 1, sizeof(text), f);
+    fclose(f);
+
+    // Typed at the prompt after starting BASIC from Wozmon
+    reset_emulator(m);
+    type_keys(m, "", 0);
+    type_keys(m, "E000R\r", 6);
+    typed.cycles = type_keys(m, text, len);
+    take_image(m, &typed);
+
+    // Loaded
+    reset_emulator(m);
+    type_keys(m, "", 0);
+    basic_load_result_t r;
+    int ok = basic_load(m, text, len, 1, &r);
+    loaded.cycles = r.cycles;
+    take_image(m, &loaded);
+
+    int same = ok && typed.lomem == loaded.lomem && typed.himem == loaded.himem &&
+               typed.pp == loaded.pp && typed.pv == loaded.pv &&
+               memcmp(typed.ram + typed.pp, loaded.ram + loaded.pp, typed.himem - typed.pp) == 0 &&
+               memcmp(typed.ram + typed.lomem, loaded.ram + loaded.lomem, typed.pv - typed.lomem) == 0;
+
+    printf("%-24s %4lu lines, program $%04X-$%04X, %lu rejected, typed %llu cycles, "
+           "loaded %llu: %s\n",
+           path, (unsigned long)r.lines, loaded.pp, (loaded.himem - 1) & 0xFFFF,
+           (unsigned long)r.errors, (unsigned long long)typed.cycles,
+           (unsigned long long)loaded.cycles, same ? "identical" : "DIFFERENT");
+    if (!same)
+    {
+        printf("  typed:  LOMEM %04X HIMEM %04X PP %04X PV %04X\n", typed.lomem, typed.himem,
+               typed.pp, typed.pv);
+        printf("  loaded: LOMEM %04X HIMEM %04X PP %04X PV %04X%s\n", loaded.lomem,
+               loaded.himem, loaded.pp, loaded.pv, ok ? "" : " (BASIC stopped)");
+    }
+    return !same;
+}
+
+int basic_check_main(int argc, char **argv)
+{
+    apple1_t *m = emulator_create();
+    int failed = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        failed |= check_file(m, argv[i]);
+    }
+    emulator_destroy(m);
+    return failed;
+}
+
+static void dump_hex(apple1_t *m, FILE *out, uint16_t from, uint16_t to)
+{
+    for (uint32_t a = from; a <= to; a++)
+    {
+        if (a == from || (a & 7) == 0)
+        {
+            fprintf(out, "%s%04X:", a == from ? "" : "\n", (unsigned)a);
+        }
+        fprintf(out, " %02X", read_memory(m, a));
+    }
+    fprintf(out, "\n");
+}
+
+int basic_image_main(const char *path, const char *image)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        perror(path);
+        return 1;
+    }
+    static char text[64 * 1024];
+    uint32_t len = fread(text, 1, sizeof(text), f);
+    fclose(f);
+
+    apple1_t *m = emulator_create();
+    reset_emulator(m);
+    type_keys(m, "", 0);
+    basic_load_result_t r;
+    if (!basic_load(m, text, len, 1, &r) || r.errors)
+    {
+        fprintf(stderr, "%s: %lu lines rejected%s\n", path, (unsigned long)r.errors,
+                r.errors ? "" : ", BASIC stopped");
+        return 1;
+    }
+
+    // What the Apple-1 cassette interface saves of a BASIC program (4A.FFW
+    // and the program), to be warm-started at $E2B3 once loaded
+    FILE *out = fopen(image, "w");
+    if (!out)
+    {
+        perror(image);
+        return 1;
+    }
+    fprintf(out, "# %s, warm start at E2B3\n", path);
+    dump_hex(m, out, BASIC_LOMEM, 0xFF);
+    dump_hex(m, out, r.program_start, r.program_end - 1);
+    fclose(out);
+    emulator_destroy(m);
+    return 0;
+}
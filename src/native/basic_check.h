@@ -0,0 +1,15 @@
+#ifndef BASIC_CHECK_H
+#define BASIC_CHECK_H
+
+// Load each BASIC source file twice, once typed in through the keyboard
+// queue at BASIC's prompt and once with basic_load(), and compare the
+// resulting program images and pointers byte for byte. Returns nonzero if
+// any file differs.
+int basic_check_main(int argc, char **argv);
+
+// Load a BASIC source file and write the zero page from LOMEM and the
+// program to `image` as a Wozmon hex dump, the way the cassette interface
+// saves them
+int basic_image_main(const char *path, const char *image);
+
+#endif // BASIC_CHECK_H
@@ -0,0 +1,329 @@
+// Host benchmark for the 6502 core.
+//
+// Runs a few fixed Apple-1 workloads with the display stubbed out and reports
+// interpreter throughput, once stepping with step6502() and once in batches
+// through run6502(). Keys are typed into the
+// emulator as soon as the previous one has been consumed, so every run of
+// a workload executes the same instruction stream; the output hash must
+// stay the same across interpreter changes.
+//
+// "program serial" runs the emulator on stdin/stdout instead (see
+// serial_host.c), and "program basic-check file.bas..." checks the BASIC
+// fast-loader against typing (basic_check.c); "program basic-image file.bas
+// file.hex" turns a program into a library image. "program trace [log]"
+// disassembles the trace dumps in a serial log (trace_host.c).
+//
+// "program parallel [threads] [reps]" runs the workloads in batches on one
+// machine per thread at once, checks they all produce the same output, and
+// reports the combined throughput.
+//
+// Built with -DFAKE6502_PROFILE (the native-profile environment), each
+// workload's execution profile is printed after its run6502() row.
+
+#include "emulator.h"
+#include "serial_host.h"
+#include "basic_check.h"
+#include "profile.h"
+#include "trace_host.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHUNK 256   // Instructions between key feed / idle checks
+#define BATCH 1024  // Cycle budget per run6502() call
+#define MAX_THREADS 64
+
+typedef struct
+{
+    const char *name;
+    const char *keys;  // Typed in order, '|' stands for RETURN
+    uint16_t idle_lo;  // Key-wait loop the workload ends in
+    uint16_t idle_hi;
+} workload_t;
+
+static const workload_t workloads[] = {
+    // Wozmon examine of the whole BASIC ROM: 4 KB of hex through ECHO
+    {"wozmon-dump", "E000.EFFF|", 0xFF29, 0xFF2D},
+
+    // Integer BASIC interpreting a FOR loop with arithmetic
+    {"basic-loop",
+     "E000R|"
+     "10 FOR I=1 TO 3000|"
+     "20 A=(A+I*7) MOD 1000|"
+     "30 NEXT I|"
+     "40 PRINT A|"
+     "50 END|"
+     "RUN|",
+     0xE003, 0xE008},
+
+    // Cellular automaton at $0300, one generation per key press
+    {"cellular",
+     "300R|12|15|"
+     "                                "
+     "                                "
+     "                                "
+     "                                ",
+     0x0520, 0x0526},
+};
+
+#define NUM_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+typedef struct
+{
+    uint64_t instructions;
+    uint64_t cycles;
+    double seconds;
+    uint32_t chars; // Display output, counted and hashed as display_stub.c does
+    uint32_t hash;
+} result_t;
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static result_t run_workload(apple1_t *m, const workload_t *w, int batched)
+{
+    result_t r = {0, 0, 0.0, 0, 2166136261u};
+    const char *k = w->keys;
+    cpu6502_t *cpu = emulator_cpu(m);
+
+    reset6502(cpu);
+
+    double start = now_seconds();
+    for (;;)
+    {
+        if (batched)
+        {
+            r.cycles += run6502(cpu, BATCH);
+            r.instructions += cpu->instructions;
+        }
+        else
+        {
+            for (int i = 0; i < CHUNK; i++)
+            {
+                r.cycles += step6502(cpu);
+            }
+            r.instructions += CHUNK;
+        }
+
+        char c;
+        while (emulator_read_output(m, &c))
+        {
+            r.chars++;
+            r.hash = (r.hash ^ (uint8_t)c) * 16777619u;
+        }
+
+        if (emulator_key_pending(m))
+        {
+            continue;
+        }
+        if (*k)
+        {
+            emulator_queue_key(m, *k == '|' ? '\r' : *k);
+            k++;
+        }
+        else if (cpu->pc >= w->idle_lo && cpu->pc <= w->idle_hi)
+        {
+            break;
+        }
+    }
+    r.seconds = now_seconds() - start;
+    return r;
+}
+
+// Ctrl+R after the workloads have dirtied RAM: the reset itself, then the
+// 6502 running flat out to Wozmon's prompt
+static void measure_reset(apple1_t *m, double setup_seconds)
+{
+    uint32_t dirty = emulator_dirty_pages(m);
+    double start = now_seconds();
+    reset_emulator(m);
+    double reset_seconds = now_seconds() - start;
+    while (emulator_cycles_to_prompt(m) == 0)
+    {
+        run_emulator(m, BATCH);
+        char c;
+        while (emulator_read_output(m, &c))
+        {
+        }
+    }
+    double prompt_seconds = now_seconds() - start;
+
+    printf("\nreset: first %.1f us; after the workloads %.2f us for %u dirty pages, "
+           "prompt after %.2f us (%u cycles)\n",
+           setup_seconds * 1e6, reset_seconds * 1e6, (unsigned)dirty, prompt_seconds * 1e6,
+           (unsigned)emulator_cycles_to_prompt(m));
+}
+
+typedef struct
+{
+    pthread_t thread;
+    apple1_t *machine;
+    int reps;
+    result_t results[NUM_WORKLOADS]; // Totals over the reps
+} worker_t;
+
+static void *run_worker(void *arg)
+{
+    worker_t *w = arg;
+    for (int rep = 0; rep < w->reps; rep++)
+    {
+        for (size_t i = 0; i < NUM_WORKLOADS; i++)
+        {
+            result_t r = run_workload(w->machine, &workloads[i], 1);
+            w->results[i].instructions += r.instructions;
+            w->results[i].cycles += r.cycles;
+            w->results[i].seconds += r.seconds;
+            w->results[i].chars = r.chars;
+            w->results[i].hash = r.hash;
+        }
+    }
+    return NULL;
+}
+
+// Every thread runs all the workloads `reps` times on a machine of its own
+static int parallel_main(int threads, int reps)
+{
+    static worker_t workers[MAX_THREADS];
+    threads = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+    reps = reps < 1 ? 1 : reps;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].machine = emulator_create();
+        if (!workers[t].machine)
+        {
+            fprintf(stderr, "No memory for machine %d\n", t);
+            return 1;
+        }
+        reset_emulator(workers[t].machine);
+        workers[t].reps = reps;
+    }
+
+    double start = now_seconds();
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_create(&workers[t].thread, NULL, run_worker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+    }
+    double seconds = now_seconds() - start;
+
+    printf("\n%-12s %8s %12s %12s %6s %8s\n", "workload", "threads", "instr", "cycles",
+           "chars", "hash");
+    int failed = 0;
+    uint64_t instructions = 0, cycles = 0;
+    for (size_t i = 0; i < NUM_WORKLOADS; i++)
+    {
+        uint64_t workload_instructions = 0, workload_cycles = 0;
+        int same = 1;
+        for (int t = 0; t < threads; t++)
+        {
+            const result_t *r = &workers[t].results[i];
+            workload_instructions += r->instructions;
+            workload_cycles += r->cycles;
+            same &= r->hash == workers[0].results[i].hash &&
+                    r->chars == workers[0].results[i].chars;
+        }
+        printf("%-12s %8d %12llu %12llu %6u %08x%s\n", workloads[i].name, threads,
+               (unsigned long long)workload_instructions, (unsigned long long)workload_cycles,
+               (unsigned)workers[0].results[i].chars, (unsigned)workers[0].results[i].hash,
+               same ? "" : "  MACHINES DIFFER");
+        failed |= !same;
+        instructions += workload_instructions;
+        cycles += workload_cycles;
+    }
+    printf("\n%d machines: %.2f Minstr/s, %.2f MHz combined, %.2f MHz each, in %.2f s\n",
+           threads, instructions / seconds / 1e6, cycles / seconds / 1e6,
+           cycles / seconds / 1e6 / threads, seconds);
+
+    for (int t = 0; t < threads; t++)
+    {
+        emulator_destroy(workers[t].machine);
+    }
+    return failed;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "serial") == 0)
+    {
+        return serial_host_main(argc > 2 ? argv[2] : NULL);
+    }
+    if (argc > 1 && strcmp(argv[1], "basic-check") == 0)
+    {
+        return basic_check_main(argc - 2, argv + 2);
+    }
+    if (argc > 3 && strcmp(argv[1], "basic-image") == 0)
+    {
+        return basic_image_main(argv[2], argv[3]);
+    }
+    if (argc > 1 && strcmp(argv[1], "trace") == 0)
+    {
+        return trace_host_main(argc > 2 ? argv[2] : NULL);
+    }
+    if (argc > 1 && strcmp(argv[1], "parallel") == 0)
+    {
+        return parallel_main(argc > 2 ? atoi(argv[2]) : 2, argc > 3 ? atoi(argv[3]) : 5);
+    }
+
+    int reps = argc > 1 ? atoi(argv[1]) : 5;
+    if (reps < 1)
+    {
+        reps = 1;
+    }
+
+    apple1_t *m = emulator_create();
+    double setup_start = now_seconds();
+    reset_emulator(m);
+    double setup_seconds = now_seconds() - setup_start;
+
+    printf("\n%-12s %-4s %10s %10s %8s %8s %8s %6s %8s\n", "workload", "mode", "instr",
+           "cycles", "Minstr/s", "MHz", "ns/inst", "chars", "hash");
+
+    for (int batched = 0; batched <= 1; batched++)
+    {
+        for (size_t i = 0; i < NUM_WORKLOADS; i++)
+        {
+#ifdef FAKE6502_PROFILE
+            profile_clear(m);
+#endif
+            // Keep the fastest of several runs to filter out host noise
+            result_t best = run_workload(m, &workloads[i], batched);
+            for (int rep = 1; rep < reps; rep++)
+            {
+                result_t r = run_workload(m, &workloads[i], batched);
+                if (r.seconds < best.seconds)
+                {
+                    best = r;
+                }
+            }
+
+            printf("%-12s %-4s %10llu %10llu %8.2f %8.2f %8.2f %6u %08x\n",
+                   workloads[i].name, batched ? "run" : "step",
+                   (unsigned long long)best.instructions,
+                   (unsigned long long)best.cycles,
+                   best.instructions / best.seconds / 1e6,
+                   best.cycles / best.seconds / 1e6,
+                   best.seconds * 1e9 / best.instructions,
+                   (unsigned)best.chars, (unsigned)best.hash);
+#ifdef FAKE6502_PROFILE
+            if (batched)
+            {
+                profile_print(m);
+            }
+#endif
+        }
+    }
+
+    measure_reset(m, setup_seconds);
+    emulator_destroy(m);
+    return 0;
+}
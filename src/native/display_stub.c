@@ -0,0 +1,101 @@
+// Host stand-in for display.cpp. There is no TFT on the native build, so
+// output is counted and hashed (and optionally echoed to stdout) instead.
+
+#include "display.h"
+#include "display_stub.h"
+#include <stdio.h>
+#include <string.h>
+
+uint32_t display_stub_chars = 0;
+uint32_t display_stub_hash = 2166136261u;
+int display_stub_echo = 0;
+
+void display_stub_reset()
+{
+    display_stub_chars = 0;
+    display_stub_hash = 2166136261u;
+}
+
+void display_init()
+{
+    display_stub_reset();
+}
+
+void display_write_char(char c)
+{
+    display_stub_chars++;
+    display_stub_hash = (display_stub_hash ^ (uint8_t)c) * 16777619u;
+
+    if (display_stub_echo)
+    {
+        putchar(c == '\r' ? '\n' : c);
+    }
+}
+
+// Only the shown terminal is counted
+static int shown = 0;
+
+void display_terminal_write_char(int terminal, char c)
+{
+    if (terminal == shown)
+    {
+        display_write_char(c);
+    }
+}
+
+void display_show(int terminal)
+{
+    shown = terminal;
+}
+
+int display_shown()
+{
+    return shown;
+}
+
+void display_write(const char *str)
+{
+    while (*str)
+    {
+        display_write_char(*str++);
+    }
+}
+
+void display_write_line(const char *str)
+{
+    display_write(str);
+    display_write_char('\n');
+}
+
+void display_clear()
+{
+}
+
+void display_update_cursor()
+{
+}
+
+void display_flush()
+{
+}
+
+void display_update()
+{
+}
+
+// Nothing is kept on the host, so a snapshot has a blank screen
+void display_get_state(uint8_t *state)
+{
+    memset(state, ' ', DISPLAY_ROWS * DISPLAY_COLS);
+    state[DISPLAY_ROWS * DISPLAY_COLS] = 0;
+    state[DISPLAY_ROWS * DISPLAY_COLS + 1] = 0;
+}
+
+void display_set_state(const uint8_t *state)
+{
+    (void)state;
+}
+
+void display_benchmark()
+{
+}
@@ -0,0 +1,27 @@
+#ifndef DISPLAY_STUB_H
+#define DISPLAY_STUB_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Characters written through display_write_char() since the last reset
+    extern uint32_t display_stub_chars;
+
+    // FNV-1a hash of everything written, used to check a workload still
+    // produces the same output after an interpreter change
+    extern uint32_t display_stub_hash;
+
+    // When set, characters are also echoed to stdout
+    extern int display_stub_echo;
+
+    void display_stub_reset();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_STUB_H
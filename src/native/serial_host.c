@@ -0,0 +1,197 @@
+// Host stand-in for the firmware's serial loop, so tools/upload.py can be
+// tried against the native build instead of a board:
+//
+//   tools/upload.py lib/cellular.bin --addr 0300 --run --native .pio/build/native/program
+//
+// "program serial NAME" starts with the software library's program NAME
+// loaded and running, as if picked from the Ctrl+O menu. Ctrl+K and Ctrl+Y
+// save and restore a snapshot in SNAPSHOT_FILE, as on the board. Ctrl+E
+// prints the execution profile in a -DFAKE6502_PROFILE build, Ctrl+U the
+// instruction trace in a -DFAKE6502_TRACE one, and Ctrl+D stops in the
+// debugger in a -DFAKE6502_DEBUG one.
+
+#include "serial_host.h"
+#include "debugger.h"
+#include "emulator.h"
+#include "fastload.h"
+#include "library.h"
+#include "profile.h"
+#include "trace.h"
+#include "snapshot_file.h"
+#include "display.h"
+#include "display_stub.h"
+#include <poll.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SLICE 20000                 // Cycles per run_emulator() call
+#define AFTER_EOF_CYCLES 100000000  // Give up on a program that never waits
+#define SNAPSHOT_FILE "apple1.snap"
+#define KEY_SAVE 0x0B                // Ctrl+K
+#define KEY_RESTORE 0x19             // Ctrl+Y
+#define KEY_PROFILE 0x05             // Ctrl+E
+#define KEY_TRACE 0x15               // Ctrl+U
+#define KEY_DEBUG 0x04               // Ctrl+D
+
+static apple1_t *machine;
+
+static uint32_t now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Same replies as apply_load() in main.cpp
+static void apply_load()
+{
+    char report[128];
+    uint8_t reply = fastload_apply(machine, report, sizeof(report));
+    fputs(report, stdout);
+    putchar(reply);
+}
+
+static uint32_t now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Same reports as the snapshot keys in main.cpp
+static void snapshot(int save)
+{
+    uint32_t start = now_us();
+    int32_t size = save ? snapshot_save(machine, &snapshot_file_backend, SNAPSHOT_FILE)
+                        : snapshot_restore(machine, &snapshot_file_backend,
+                                           SNAPSHOT_FILE);
+    if (size < 0)
+    {
+        printf("\n[SNAPSHOT %s failed: %s]\n", save ? "save" : "restore",
+               snapshot_error_name(size));
+        return;
+    }
+    printf("\n[SNAPSHOT %s %ld bytes in %lu us]\n", save ? "saved" : "restored", (long)size,
+           (unsigned long)(now_us() - start));
+}
+
+static void take_input(const uint8_t *buf, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        switch (fastload_feed(buf[i], now_ms()))
+        {
+        case FASTLOAD_IDLE:
+#ifdef FAKE6502_DEBUG
+            if (debugger_halted(machine) && (buf[i] >= ' ' || buf[i] == '\r' || buf[i] == '\n' ||
+                                      buf[i] == 0x08))
+            {
+                debugger_key(buf[i]);
+                break;
+            }
+            if (buf[i] == KEY_DEBUG)
+            {
+                debugger_break(machine);
+                break;
+            }
+#endif
+            if (buf[i] == KEY_SAVE || buf[i] == KEY_RESTORE)
+            {
+                snapshot(buf[i] == KEY_SAVE);
+            }
+#ifdef FAKE6502_PROFILE
+            else if (buf[i] == KEY_PROFILE)
+            {
+                profile_print(machine);
+            }
+#endif
+#ifdef FAKE6502_TRACE
+            else if (buf[i] == KEY_TRACE)
+            {
+                trace_print(machine);
+            }
+#endif
+            else
+            {
+                emulator_queue_key(machine, buf[i]);
+            }
+            break;
+
+        case FASTLOAD_BLOCK:
+            apply_load();
+            break;
+
+        case FASTLOAD_ERROR:
+            printf("\n[LOAD rejected: bad length or CRC]\n");
+            putchar(FASTLOAD_NAK);
+            break;
+
+        case FASTLOAD_BUSY:
+            break;
+        }
+    }
+}
+
+int serial_host_main(const char *program)
+{
+    int input_open = 1;
+    uint64_t after_eof = 0;
+
+    display_stub_echo = 1;
+    machine = emulator_create();
+    reset_emulator(machine);
+
+    if (program)
+    {
+        int index = library_find(program);
+        if (index < 0 || library_load(machine, index) < 0)
+        {
+            fprintf(stderr, "%s: not in the library, or doesn't fit in RAM\n", program);
+            return 1;
+        }
+        emulator_run_from(machine, library_entry(index)->entry);
+    }
+
+    for (;;)
+    {
+        // Read only while the key queue has room, like service_io(); wait a
+        // little when the 6502 has nothing else to do
+        uint32_t room = emulator_key_queue_free(machine);
+        if (input_open && room > 0)
+        {
+            struct pollfd pfd = {0, POLLIN, 0};
+            if (poll(&pfd, 1, emulator_waiting_for_key(machine) ? 10 : 0) > 0)
+            {
+                uint8_t buf[256];
+                int n = read(0, buf, room < sizeof(buf) ? room : sizeof(buf));
+                if (n <= 0)
+                {
+                    input_open = 0;
+                }
+                take_input(buf, n);
+            }
+        }
+
+        uint32_t ran = run_emulator(machine, SLICE);
+        char c;
+        while (emulator_read_output(machine, &c))
+        {
+            display_write_char(c);
+        }
+        fflush(stdout);
+
+        if (!input_open)
+        {
+            after_eof += ran;
+            if ((emulator_waiting_for_key(machine) && !emulator_key_pending(machine)) ||
+                after_eof > AFTER_EOF_CYCLES)
+            {
+                break;
+            }
+        }
+    }
+    putchar('\n');
+    emulator_destroy(machine);
+    return 0;
+}
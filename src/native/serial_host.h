@@ -0,0 +1,11 @@
+#ifndef SERIAL_HOST_H
+#define SERIAL_HOST_H
+
+// Run the emulator with stdin/stdout standing in for the serial port, the
+// way loop() drives it on the board: keys and fast-load frames in, display
+// output and load reports out. Returns when stdin is closed and the 6502
+// has gone back to waiting for a key. `program`, if not NULL, names a
+// library program to load and start first.
+int serial_host_main(const char *program);
+
+#endif // SERIAL_HOST_H
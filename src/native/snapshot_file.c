@@ -0,0 +1,24 @@
+#include "snapshot_file.h"
+#include <stdio.h>
+
+static void *file_open(const char *name, int write)
+{
+    return fopen(name, write ? "wb" : "rb");
+}
+
+static uint32_t file_read(void *file, uint8_t *data, uint32_t len)
+{
+    return fread(data, 1, len, (FILE *)file);
+}
+
+static uint32_t file_write(void *file, const uint8_t *data, uint32_t len)
+{
+    return fwrite(data, 1, len, (FILE *)file);
+}
+
+static void file_close(void *file)
+{
+    fclose((FILE *)file);
+}
+
+const snapshot_backend_t snapshot_file_backend = {file_open, file_read, file_write, file_close};
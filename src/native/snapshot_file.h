@@ -0,0 +1,9 @@
+#ifndef SNAPSHOT_FILE_H
+#define SNAPSHOT_FILE_H
+
+#include "snapshot.h"
+
+// Snapshots as plain files on the host, named as given
+extern const snapshot_backend_t snapshot_file_backend;
+
+#endif // SNAPSHOT_FILE_H
@@ -0,0 +1,112 @@
+// "program trace [log]": turn the raw records trace_print() writes back
+// into instructions, with the registers each left and the cycle it ended on
+
+#include "trace_host.h"
+#include "disasm6502.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    unsigned pc, bytes[3], a, x, y, sp, p, cycle;
+} record_t;
+
+#define MAX_RECORDS 65536 // Largest dump read, whatever TRACE_RECORDS was
+
+static record_t records[MAX_RECORDS];
+
+static void flags(unsigned p, char *out)
+{
+    const char *names = "NV-BDIZC";
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = p & (0x80 >> i) ? names[i] : '.';
+    }
+    out[8] = 0;
+}
+
+// Cycle stamps are only the low byte; count back from the last one
+static void print_dump(uint32_t n, unsigned long long last_cycle)
+{
+    unsigned long long cycle = last_cycle;
+    static unsigned long long stamps[MAX_RECORDS];
+    for (uint32_t i = n; i-- > 0;)
+    {
+        stamps[i] = cycle;
+        if (i > 0)
+        {
+            cycle -= (records[i].cycle - records[i - 1].cycle) & 0xFF;
+        }
+    }
+
+    printf("%12s  %-4s  %-8s  %-14s  %-2s %-2s %-2s %-2s  %s\n", "cycle", "PC", "bytes",
+           "instruction", "A", "X", "Y", "SP", "P");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const record_t *r = &records[i];
+        uint8_t bytes[3] = {r->bytes[0], r->bytes[1], r->bytes[2]};
+        char text[24], hex[12], p[9];
+        int len = disasm6502(r->pc, bytes, text, sizeof(text));
+        int used = 0;
+        for (int b = 0; b < len; b++)
+        {
+            used += snprintf(hex + used, sizeof(hex) - used, b ? " %02X" : "%02X", bytes[b]);
+        }
+        flags(r->p, p);
+        printf("%12llu  %04X  %-8s  %-14s  %02X %02X %02X %02X  %s\n", stamps[i], r->pc, hex,
+               text, r->a, r->x, r->y, r->sp, p);
+    }
+}
+
+int trace_host_main(const char *path)
+{
+    FILE *f = path ? fopen(path, "r") : stdin;
+    if (!f)
+    {
+        perror(path);
+        return 1;
+    }
+
+    char line[256];
+    int dumps = 0;
+    int in_dump = 0;
+    uint32_t n = 0;
+    unsigned long long last_cycle = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned long count;
+        record_t r;
+        if (sscanf(line, "[TRACE %lu instructions, cycle %llu]", &count, &last_cycle) == 2)
+        {
+            in_dump = 1;
+            n = 0;
+        }
+        else if (in_dump && strncmp(line, "[TRACE end]", 11) == 0)
+        {
+            if (dumps)
+            {
+                putchar('\n');
+            }
+            print_dump(n, last_cycle);
+            dumps++;
+            in_dump = 0;
+        }
+        else if (in_dump && n < MAX_RECORDS &&
+                 sscanf(line, "T %x %x %x %x %x %x %x %x %x %x", &r.pc, &r.bytes[0],
+                        &r.bytes[1], &r.bytes[2], &r.a, &r.x, &r.y, &r.sp, &r.p,
+                        &r.cycle) == 10)
+        {
+            records[n++] = r;
+        }
+    }
+    if (path)
+    {
+        fclose(f);
+    }
+    if (!dumps)
+    {
+        fprintf(stderr, "No trace dump found\n");
+        return 1;
+    }
+    return 0;
+}
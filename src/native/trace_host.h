@@ -0,0 +1,9 @@
+#ifndef TRACE_HOST_H
+#define TRACE_HOST_H
+
+// Disassemble the trace dumps (Ctrl+U, or a stuck CPU, in a -DFAKE6502_TRACE
+// build) found in a captured serial log, or stdin if `path` is NULL. Other
+// lines are skipped. Returns nonzero if there was no dump.
+int trace_host_main(const char *path);
+
+#endif // TRACE_HOST_H
@@ -0,0 +1,173 @@
+#include "pacing.h"
+#include <math.h>
+
+#define PACING_SLICE_US 1000     // Run the CPU in slices of at least 1 ms
+#define PACING_MAX_SLICE_US 5000 // ...and at most 5 ms
+#define PACING_MAX_LAG_US 100000 // Give up on lag beyond 100 ms
+#define UNTHROTTLED_SLICE 20000  // Cycles per slice when not paced
+
+static uint32_t us_to_cycles(const pacing_t *p, uint32_t us)
+{
+    return (uint64_t)us * p->clock_hz / 1000000;
+}
+
+static int32_t current_drift_us(const pacing_t *p)
+{
+    return (int32_t)(-p->debt * 1000000 / p->clock_hz);
+}
+
+// Sample how far behind (negative) or ahead wall time the CPU is when it
+// gets to run
+static void sample_drift(pacing_t *p)
+{
+    int32_t drift = current_drift_us(p);
+    if (drift < p->drift_min_us)
+    {
+        p->drift_min_us = drift;
+    }
+    if (drift > p->drift_max_us)
+    {
+        p->drift_max_us = drift;
+    }
+    p->drift_sum += drift;
+    p->drift_sum_sq += (int64_t)drift * drift;
+    p->drift_samples++;
+}
+
+static void reset_window(pacing_t *p, uint32_t now_us)
+{
+    p->window_start_us = now_us;
+    p->window_cycles = 0;
+    p->window_slices = 0;
+    p->window_dropped_us = 0;
+    p->drift_min_us = p->drift_max_us = current_drift_us(p);
+    p->drift_sum = 0;
+    p->drift_sum_sq = 0;
+    p->drift_samples = 0;
+}
+
+void pacing_init(pacing_t *p, uint32_t now_us)
+{
+    pacing_set_mode(p, PACING_AUTHENTIC, now_us);
+}
+
+void pacing_set_mode(pacing_t *p, pacing_mode_t new_mode, uint32_t now_us)
+{
+    p->mode = new_mode;
+    p->clock_hz = APPLE1_CLOCK_HZ * (new_mode == PACING_TURBO ? PACING_TURBO_MULTIPLIER : 1);
+
+    // Start the schedule afresh from now
+    p->last_us = now_us;
+    p->credit_rem = 0;
+    p->debt = 0;
+    reset_window(p, now_us);
+}
+
+pacing_mode_t pacing_get_mode(const pacing_t *p)
+{
+    return p->mode;
+}
+
+const char *pacing_mode_name(pacing_mode_t m)
+{
+    switch (m)
+    {
+    case PACING_AUTHENTIC:
+        return "1.023 MHz";
+    case PACING_TURBO:
+        return "turbo";
+    case PACING_UNTHROTTLED:
+        return "unthrottled";
+    default:
+        return "?";
+    }
+}
+
+uint32_t pacing_budget(pacing_t *p, uint32_t now_us)
+{
+    uint32_t elapsed = now_us - p->last_us; // Wraps correctly with micros()
+    p->last_us = now_us;
+
+    if (p->mode == PACING_UNTHROTTLED)
+    {
+        return UNTHROTTLED_SLICE;
+    }
+
+    // Credit the cycles the real machine would have run since the last call
+    uint64_t acc = (uint64_t)elapsed * p->clock_hz + p->credit_rem;
+    p->debt += acc / 1000000;
+    p->credit_rem = acc % 1000000;
+
+    // After a long stall (e.g. a full screen redraw) don't try to run
+    // hundreds of milliseconds of catch-up; drop the excess lag instead
+    int64_t max_debt = us_to_cycles(p, PACING_MAX_LAG_US);
+    if (p->debt > max_debt)
+    {
+        p->window_dropped_us += (uint32_t)((p->debt - max_debt) * 1000000 / p->clock_hz);
+        p->debt = max_debt;
+    }
+    sample_drift(p);
+
+    if (p->debt < (int64_t)us_to_cycles(p, PACING_SLICE_US))
+    {
+        return 0;
+    }
+
+    uint32_t max_slice = us_to_cycles(p, PACING_MAX_SLICE_US);
+    return p->debt > max_slice ? max_slice : (uint32_t)p->debt;
+}
+
+void pacing_account(pacing_t *p, uint32_t cycles)
+{
+    p->window_cycles += cycles;
+    p->window_slices++;
+
+    if (p->mode == PACING_UNTHROTTLED)
+    {
+        return;
+    }
+
+    p->debt -= cycles;
+}
+
+void pacing_fast_forward(pacing_t *p, uint32_t now_us)
+{
+    uint32_t elapsed = now_us - p->last_us;
+    p->last_us = now_us;
+
+    if (p->mode == PACING_UNTHROTTLED)
+    {
+        return;
+    }
+
+    // Everything owed, up to now, counts as spent in the loop
+    uint64_t acc = (uint64_t)elapsed * p->clock_hz + p->credit_rem;
+    p->credit_rem = acc % 1000000;
+    p->debt += acc / 1000000;
+    if (p->debt > 0)
+    {
+        p->window_cycles += p->debt;
+    }
+    p->debt = 0;
+}
+
+void pacing_get_stats(pacing_t *p, pacing_stats_t *stats, uint32_t now_us)
+{
+    stats->window_us = now_us - p->window_start_us;
+    stats->cycles = p->window_cycles;
+    stats->drift_us = current_drift_us(p);
+    stats->drift_min_us = p->drift_min_us;
+    stats->drift_max_us = p->drift_max_us;
+    stats->slices = p->window_slices;
+    stats->dropped_us = p->window_dropped_us;
+    stats->jitter_us = 0;
+
+    if (p->drift_samples > 0)
+    {
+        double mean = (double)p->drift_sum / p->drift_samples;
+        double var = (double)p->drift_sum_sq / p->drift_samples - mean * mean;
+        stats->jitter_us = var > 0 ? (uint32_t)sqrt(var) : 0;
+    }
+
+    reset_window(p, now_us);
+}
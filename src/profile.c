@@ -0,0 +1,203 @@
+#ifdef FAKE6502_PROFILE
+
+#include "profile.h"
+#include "disasm6502.h"
+#include "emulator.h"
+#include "fake6502.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The PC histogram only covers pages that can hold code: RAM and the ROMs.
+// Counts are 16 bits to keep it small on the ESP32 (24.5 KB with 8 KB of
+// RAM). When one would overflow they are all halved and from then on only
+// every other instruction is counted, then every fourth, and so on; each
+// count stands for 1 << hist_shift instructions.
+#define BASIC_PAGE 0xE0 // BASIC, $E000-$EFFF
+#define BASIC_PAGES 16
+#define WOZMON_PAGE 0xFF // Wozmon, $FF00-$FFFF
+#define IO_REGISTERS 0xD010 // KBD, KBDCR, DSP, DSPCR
+
+// One machine is profiled at a time, the one last passed to profile_clear()
+static apple1_t *machine;
+
+static uint8_t page_slot[256]; // Histogram page + 1, 0 if not covered
+static uint16_t *hist;
+static uint32_t hist_size;
+static uint32_t hist_shift;
+static uint64_t sample_mask; // (1 << hist_shift) - 1
+
+static uint64_t instructions, cycles;
+static uint64_t op_count[256], op_cycles[256];
+static uint32_t io_reads[4], io_writes[4];
+
+static void setup_hist()
+{
+    uint32_t pages = 0;
+    for (uint32_t page = 0; page < emulator_ram_size() >> 8; page++)
+    {
+        page_slot[page] = ++pages;
+    }
+    for (uint32_t page = BASIC_PAGE; page < BASIC_PAGE + BASIC_PAGES; page++)
+    {
+        page_slot[page] = ++pages;
+    }
+    page_slot[WOZMON_PAGE] = ++pages;
+
+    hist = calloc(pages << 8, sizeof(hist[0]));
+    if (!hist)
+    {
+        printf("Profile: no memory for the PC histogram\n");
+        memset(page_slot, 0, sizeof(page_slot));
+        return;
+    }
+    hist_size = pages << 8;
+}
+
+void profile_clear(apple1_t *m)
+{
+    machine = m;
+    if (!hist)
+    {
+        setup_hist();
+    }
+    if (hist)
+    {
+        memset(hist, 0, hist_size * sizeof(hist[0]));
+    }
+    hist_shift = 0;
+    sample_mask = 0;
+    instructions = cycles = 0;
+    memset(op_count, 0, sizeof(op_count));
+    memset(op_cycles, 0, sizeof(op_cycles));
+    memset(io_reads, 0, sizeof(io_reads));
+    memset(io_writes, 0, sizeof(io_writes));
+}
+
+void profile6502(const cpu6502_t *cpu, uint16_t pc, uint32_t ticks)
+{
+    if (cpu->context != machine)
+    {
+        return;
+    }
+    instructions++;
+    cycles += ticks;
+
+    // The opcode is read from the page map, so code in the I/O page (which
+    // no program has any business running) isn't read twice
+    const uint8_t *page = cpu->read_pages[pc >> 8];
+    if (page)
+    {
+        uint8_t op = page[pc & 0xFF];
+        op_count[op]++;
+        op_cycles[op] += ticks;
+    }
+
+    uint8_t slot = page_slot[pc >> 8];
+    if (slot && (instructions & sample_mask) == 0 &&
+        ++hist[(slot - 1) << 8 | (pc & 0xFF)] == 0xFFFF)
+    {
+        for (uint32_t i = 0; i < hist_size; i++)
+        {
+            hist[i] >>= 1;
+        }
+        hist_shift++;
+        sample_mask = sample_mask << 1 | 1;
+    }
+}
+
+void profile_io(const cpu6502_t *cpu, uint16_t address, int write)
+{
+    if (cpu->context == machine && (address & ~3) == IO_REGISTERS)
+    {
+        (write ? io_writes : io_reads)[address & 3]++;
+    }
+}
+
+// Keep `top` as the indexes of the largest `n` values seen, largest first
+static void rank(uint32_t *top, uint64_t *value, uint32_t *n, uint32_t index, uint64_t v)
+{
+    if (v == 0 || (*n == PROFILE_TOP && v <= value[PROFILE_TOP - 1]))
+    {
+        return;
+    }
+    uint32_t i = *n < PROFILE_TOP ? (*n)++ : PROFILE_TOP - 1;
+    for (; i > 0 && value[i - 1] < v; i--)
+    {
+        top[i] = top[i - 1];
+        value[i] = value[i - 1];
+    }
+    top[i] = index;
+    value[i] = v;
+}
+
+static uint16_t slot_address(uint32_t index)
+{
+    for (uint32_t page = 0; page < 256; page++)
+    {
+        if (page_slot[page] == (index >> 8) + 1)
+        {
+            return page << 8 | (index & 0xFF);
+        }
+    }
+    return 0;
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+void profile_print(apple1_t *m)
+{
+    uint32_t top[PROFILE_TOP];
+    uint64_t value[PROFILE_TOP];
+    uint32_t n = 0;
+    char name[4];
+
+    if (m != machine)
+    {
+        printf("\n[PROFILE was of another machine, profiling this one now]\n");
+        profile_clear(m);
+        return;
+    }
+
+    printf("\n[PROFILE %llu instructions, %llu cycles]\n", (unsigned long long)instructions,
+           (unsigned long long)cycles);
+
+    for (uint32_t i = 0; i < hist_size; i++)
+    {
+        rank(top, value, &n, i, hist[i]);
+    }
+    printf("Hot addresses (share of instructions):\n");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint16_t address = slot_address(top[i]);
+        mnemonic6502(read_memory(machine, address), name);
+        printf("  $%04X %s %5.1f%%\n", address, name,
+               percent(value[i] << hist_shift, instructions));
+    }
+
+    n = 0;
+    for (uint32_t op = 0; op < 256; op++)
+    {
+        rank(top, value, &n, op, op_cycles[op]);
+    }
+    printf("Opcodes (share of cycles, of instructions):\n");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mnemonic6502(top[i], name);
+        printf("  $%02X %s %5.1f%% %5.1f%%\n", (unsigned)top[i], name,
+               percent(value[i], cycles), percent(op_count[top[i]], instructions));
+    }
+
+    printf("I/O reads/writes: KBD %lu/%lu, KBDCR %lu/%lu, DSP %lu/%lu, DSPCR %lu/%lu\n",
+           (unsigned long)io_reads[0], (unsigned long)io_writes[0],
+           (unsigned long)io_reads[1], (unsigned long)io_writes[1],
+           (unsigned long)io_reads[2], (unsigned long)io_writes[2],
+           (unsigned long)io_reads[3], (unsigned long)io_writes[3]);
+
+    profile_clear(machine);
+}
+
+#endif // FAKE6502_PROFILE
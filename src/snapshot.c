@@ -0,0 +1,371 @@
+#include "snapshot.h"
+#include "display.h"
+#include "emulator.h"
+#include "library.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Layout, multi-byte fields little-endian:
+//
+//   "A1SN" version ram_kb base_hash(4)
+//   PC(2) A X Y SP P kbd_data kbd_strobe last_char
+//   display delta   DISPLAY_STATE_SIZE bytes against blanks
+//   RAM delta       emulator_ram_size() bytes against the boot image
+//
+// A delta is a sequence of runs: a byte c < 0x80 is followed by c + 1
+// bytes XORed with the base, and c >= 0x80 plus one more byte skip
+// ((c & 0x7F) << 8 | byte) + 1 bytes equal to it.
+
+#define MAGIC "A1SN"
+#define MAX_LITERALS 128
+#define MAX_SKIP 0x8000
+#define TEXT_SIZE (DISPLAY_ROWS * DISPLAY_COLS)
+
+// The backend is read and written through a small buffer
+static struct
+{
+    const snapshot_backend_t *backend;
+    void *file;
+    uint8_t buf[128];
+    uint32_t pos, len;
+    uint32_t total;
+    int failed;
+} io;
+
+static apple1_t *machine;   // Being saved or restored
+static const uint8_t *base; // Boot image of RAM
+static uint8_t *screen;     // Display state
+static uint32_t ram_size;
+
+static void flush()
+{
+    if (io.len && io.backend->write(io.file, io.buf, io.len) != io.len)
+    {
+        io.failed = 1;
+    }
+    io.total += io.len;
+    io.len = 0;
+}
+
+static void put(uint8_t b)
+{
+    io.buf[io.len++] = b;
+    if (io.len == sizeof(io.buf))
+    {
+        flush();
+    }
+}
+
+static void put16(uint16_t v)
+{
+    put(v & 0xFF);
+    put(v >> 8);
+}
+
+static int get(uint8_t *b)
+{
+    if (io.pos == io.len)
+    {
+        io.len = io.backend->read(io.file, io.buf, sizeof(io.buf));
+        io.pos = 0;
+        if (io.len == 0)
+        {
+            return 0;
+        }
+        io.total += io.len;
+    }
+    *b = io.buf[io.pos++];
+    return 1;
+}
+
+static uint8_t ram_delta(uint32_t i)
+{
+    return read_memory(machine, i) ^ base[i];
+}
+
+static uint8_t screen_base(uint32_t i)
+{
+    return i < TEXT_SIZE ? ' ' : 0;
+}
+
+static uint8_t screen_delta(uint32_t i)
+{
+    return screen[i] ^ screen_base(i);
+}
+
+static uint32_t unchanged_run(uint8_t (*delta)(uint32_t), uint32_t i, uint32_t len,
+                              uint32_t max)
+{
+    uint32_t n = 0;
+    while (i + n < len && n < max && delta(i + n) == 0)
+    {
+        n++;
+    }
+    return n;
+}
+
+static void put_delta(uint8_t (*delta)(uint32_t), uint32_t len)
+{
+    uint32_t i = 0;
+    while (i < len)
+    {
+        // A skip costs two bytes, so a single unchanged byte between changed
+        // ones goes in with them
+        uint32_t run = unchanged_run(delta, i, len, MAX_SKIP);
+        if (run >= 2 || i + run == len)
+        {
+            put(0x80 | (run - 1) >> 8);
+            put((run - 1) & 0xFF);
+            i += run;
+            continue;
+        }
+
+        uint32_t start = i;
+        while (i < len && i - start < MAX_LITERALS)
+        {
+            uint32_t ahead = unchanged_run(delta, i, len, 3);
+            if (ahead == 3 || (ahead && i + ahead == len))
+            {
+                break;
+            }
+            i++;
+        }
+        put(i - start - 1);
+        for (uint32_t j = start; j < i; j++)
+        {
+            put(delta(j));
+        }
+    }
+}
+
+// Decode a delta, passing each changed byte to `apply` (if not NULL).
+// Returns 0 if it is truncated or runs past `len`.
+static int get_delta(uint32_t len, void (*apply)(uint32_t i, uint8_t d))
+{
+    uint32_t i = 0;
+    while (i < len)
+    {
+        uint8_t c, b;
+        if (!get(&c))
+        {
+            return 0;
+        }
+        if (c & 0x80)
+        {
+            if (!get(&b))
+            {
+                return 0;
+            }
+            i += ((c & 0x7F) << 8 | b) + 1;
+            continue;
+        }
+        for (uint32_t n = c + 1; n; n--, i++)
+        {
+            if (i >= len || !get(&b))
+            {
+                return 0;
+            }
+            if (apply)
+            {
+                apply(i, b);
+            }
+        }
+    }
+    return i == len;
+}
+
+static void apply_ram(uint32_t i, uint8_t d)
+{
+    write_memory(machine, i, base[i] ^ d);
+}
+
+static void apply_screen(uint32_t i, uint8_t d)
+{
+    screen[i] = screen_base(i) ^ d;
+}
+
+// FNV-1a of the boot image, so a snapshot isn't applied against a different
+// one
+static uint32_t base_hash()
+{
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < ram_size; i++)
+    {
+        h = (h ^ base[i]) * 16777619u;
+    }
+    return h;
+}
+
+// One buffer for the boot image and the display state, only while needed
+static int setup(apple1_t *m, const snapshot_backend_t *backend)
+{
+    machine = m;
+    ram_size = emulator_ram_size();
+    uint8_t *mem = malloc(ram_size + DISPLAY_STATE_SIZE);
+    if (!mem)
+    {
+        return 0;
+    }
+    library_boot_image(mem);
+    base = mem;
+    screen = mem + ram_size;
+    memset(&io, 0, sizeof(io));
+    io.backend = backend;
+    return 1;
+}
+
+static void cleanup()
+{
+    free((void *)base);
+    base = screen = NULL;
+}
+
+int32_t snapshot_save(apple1_t *m, const snapshot_backend_t *backend, const char *name)
+{
+    if (!setup(m, backend))
+    {
+        return SNAPSHOT_NO_MEMORY;
+    }
+    io.file = backend->open(name, 1);
+    if (!io.file)
+    {
+        cleanup();
+        return SNAPSHOT_IO_ERROR;
+    }
+
+    keyboard_state_t kbd;
+    emulator_get_keyboard(m, &kbd);
+    display_get_state(screen);
+
+    for (const char *c = MAGIC; *c; c++)
+    {
+        put(*c);
+    }
+    put(SNAPSHOT_VERSION);
+    put(ram_size / 1024);
+    uint32_t hash = base_hash();
+    put16(hash & 0xFFFF);
+    put16(hash >> 16);
+
+    const cpu6502_t *cpu = emulator_cpu(m);
+    put16(cpu->pc);
+    put(cpu->a);
+    put(cpu->x);
+    put(cpu->y);
+    put(cpu->sp);
+    put(getP(cpu));
+    put(kbd.kbd_data);
+    put(kbd.kbd_strobe);
+    put(kbd.last_char);
+
+    put_delta(screen_delta, DISPLAY_STATE_SIZE);
+    put_delta(ram_delta, ram_size);
+    flush();
+
+    backend->close(io.file);
+    cleanup();
+    return io.failed ? SNAPSHOT_IO_ERROR : (int32_t)io.total;
+}
+
+// Read the whole snapshot, applying it only if `apply` is set
+static int32_t read_snapshot(const char *name, int apply)
+{
+    io.file = io.backend->open(name, 0);
+    if (!io.file)
+    {
+        return SNAPSHOT_IO_ERROR;
+    }
+    io.pos = io.len = io.total = 0;
+
+    uint8_t h[20]; // Up to the deltas
+    int ok = 1;
+    for (uint32_t i = 0; i < sizeof(h) && ok; i++)
+    {
+        ok = get(&h[i]);
+    }
+    if (apply)
+    {
+        for (uint32_t i = 0; i < DISPLAY_STATE_SIZE; i++)
+        {
+            screen[i] = screen_base(i);
+        }
+    }
+
+    int32_t result = SNAPSHOT_OK;
+    uint32_t hash = h[6] | h[7] << 8 | h[8] << 16 | (uint32_t)h[9] << 24;
+    if (!ok || memcmp(h, MAGIC, 4) != 0 || h[4] != SNAPSHOT_VERSION)
+    {
+        result = SNAPSHOT_BAD_FILE;
+    }
+    else if (h[5] != ram_size / 1024 || hash != base_hash())
+    {
+        result = SNAPSHOT_OTHER_MACHINE;
+    }
+    else if (!get_delta(DISPLAY_STATE_SIZE, apply ? apply_screen : NULL))
+    {
+        result = SNAPSHOT_BAD_FILE;
+    }
+    else
+    {
+        if (apply)
+        {
+            for (uint32_t i = 0; i < ram_size; i++)
+            {
+                write_memory(machine, i, base[i]);
+            }
+        }
+        uint8_t extra;
+        if (!get_delta(ram_size, apply ? apply_ram : NULL) || get(&extra))
+        {
+            result = SNAPSHOT_BAD_FILE;
+        }
+    }
+    io.backend->close(io.file);
+
+    if (result == SNAPSHOT_OK && apply)
+    {
+        cpu6502_t *cpu = emulator_cpu(machine);
+        cpu->pc = h[10] | h[11] << 8;
+        cpu->a = h[12];
+        cpu->x = h[13];
+        cpu->y = h[14];
+        cpu->sp = h[15];
+        setP(cpu, h[16]);
+        keyboard_state_t kbd = {h[17], h[18], (char)h[19]};
+        emulator_set_keyboard(machine, &kbd);
+        display_set_state(screen);
+    }
+    return result == SNAPSHOT_OK ? (int32_t)io.total : result;
+}
+
+int32_t snapshot_restore(apple1_t *m, const snapshot_backend_t *backend, const char *name)
+{
+    if (!setup(m, backend))
+    {
+        return SNAPSHOT_NO_MEMORY;
+    }
+    int32_t result = read_snapshot(name, 0);
+    if (result >= 0)
+    {
+        result = read_snapshot(name, 1);
+    }
+    cleanup();
+    return result;
+}
+
+const char *snapshot_error_name(int32_t error)
+{
+    switch (error)
+    {
+    case SNAPSHOT_IO_ERROR:
+        return "can't read or write it";
+    case SNAPSHOT_BAD_FILE:
+        return "not a snapshot";
+    case SNAPSHOT_OTHER_MACHINE:
+        return "taken with other RAM or boot programs";
+    case SNAPSHOT_NO_MEMORY:
+        return "out of memory";
+    default:
+        return "ok";
+    }
+}
@@ -0,0 +1,41 @@
+#include "snapshot_littlefs.h"
+#include <LittleFS.h>
+
+static bool mounted = false;
+
+static void *fs_open(const char *name, int write)
+{
+    if (!mounted)
+    {
+        mounted = LittleFS.begin(true);
+        if (!mounted)
+        {
+            return NULL;
+        }
+    }
+    File f = LittleFS.open(name, write ? "w" : "r");
+    if (!f)
+    {
+        return NULL;
+    }
+    return new File(f);
+}
+
+static uint32_t fs_read(void *file, uint8_t *data, uint32_t len)
+{
+    return static_cast<File *>(file)->read(data, len);
+}
+
+static uint32_t fs_write(void *file, const uint8_t *data, uint32_t len)
+{
+    return static_cast<File *>(file)->write(data, len);
+}
+
+static void fs_close(void *file)
+{
+    File *f = static_cast<File *>(file);
+    f->close();
+    delete f;
+}
+
+const snapshot_backend_t snapshot_littlefs_backend = {fs_open, fs_read, fs_write, fs_close};
@@ -0,0 +1,75 @@
+#ifdef FAKE6502_TRACE
+
+#include "trace.h"
+#include "emulator.h"
+#include "fake6502.h"
+#include <stdio.h>
+
+#if TRACE_RECORDS & (TRACE_RECORDS - 1)
+#error "TRACE_RECORDS must be a power of two"
+#endif
+
+// PC and the registers after the instruction. There is no room for a full
+// cycle stamp, so each record keeps the low byte of the cycle count; as no
+// instruction takes 256 cycles, the stamps can be rebuilt backwards from the
+// count trace_print() gives for the last one.
+typedef struct
+{
+    uint16_t pc;
+    uint8_t a, x, y, sp, p;
+    uint8_t cycle;
+} trace_record_t;
+
+// One machine is traced at a time, the one last passed to trace_clear()
+static const apple1_t *machine;
+static trace_record_t ring[TRACE_RECORDS];
+static uint32_t head;    // Records written
+static uint64_t cycles; // Cycles after the last one
+
+void trace_clear(const apple1_t *m)
+{
+    machine = m;
+    head = 0;
+    cycles = 0;
+}
+
+void trace6502(const cpu6502_t *cpu, uint16_t pc, uint8_t a, uint8_t x, uint8_t y,
+               uint8_t sp, uint8_t p, uint32_t ticks)
+{
+    if (cpu->context != machine)
+    {
+        return;
+    }
+    cycles += ticks;
+    trace_record_t *r = &ring[head++ & (TRACE_RECORDS - 1)];
+    r->pc = pc;
+    r->a = a;
+    r->x = x;
+    r->y = y;
+    r->sp = sp;
+    r->p = p;
+    r->cycle = cycles;
+}
+
+void trace_print(apple1_t *m)
+{
+    if (m != machine)
+    {
+        printf("\n[TRACE was of another machine, tracing this one now]\n");
+        trace_clear(m);
+        return;
+    }
+    uint32_t n = head < TRACE_RECORDS ? head : TRACE_RECORDS;
+    printf("\n[TRACE %lu instructions, cycle %llu]\n", (unsigned long)n,
+           (unsigned long long)cycles);
+    for (uint32_t i = head - n; i != head; i++)
+    {
+        const trace_record_t *r = &ring[i & (TRACE_RECORDS - 1)];
+        printf("T %04X %02X %02X %02X %02X %02X %02X %02X %02X %02X\n", r->pc,
+               read_memory(m, r->pc), read_memory(m, r->pc + 1), read_memory(m, r->pc + 2), r->a,
+               r->x, r->y, r->sp, r->p, r->cycle);
+    }
+    printf("[TRACE end]\n");
+}
+
+#endif // FAKE6502_TRACE
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Pack the programs listed in programs/library.txt into include/library_blob.h.
+
+Each line of the catalog is
+
+    name  file  load  entry  [boot]  title
+
+where file is a raw binary loaded at `load` (hex), or a Wozmon hex dump
+(.hex, lines of "ADDR: bytes") that carries its own addresses, in which case
+load is "-". A file of "-" loads nothing and just jumps to entry. "boot"
+entries are loaded at power-on without being run. Each run of consecutive
+addresses becomes a segment, compressed as its own LZ4 block.
+
+PlatformIO runs this before every build (extra_scripts); the header is only
+rewritten when its contents change. It can also be run by hand:
+
+    tools/mklibrary.py
+"""
+
+import os
+import sys
+
+CATALOG = "programs/library.txt"
+OUTPUT = "include/library_blob.h"
+
+MIN_MATCH = 4
+MAX_OFFSET = 0xFFFF
+LAST_LITERALS = 5   # LZ4 block rules: the last 5 bytes are literals, and
+MATCH_LIMIT = 12    # no match starts within 12 bytes of the end
+CHAIN = 64          # Candidates tried per position
+
+
+def lz4_length(n):
+    out = bytearray()
+    n -= 15
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+    return out
+
+
+def lz4_compress(data):
+    """Greedy LZ4 block compression with hash chains."""
+    n = len(data)
+    out = bytearray()
+    heads = {}
+    anchor = i = 0
+
+    def emit(literals, offset=None, match=0):
+        lit = len(literals)
+        ml = match - MIN_MATCH if offset else 0
+        out.append((min(lit, 15) << 4) | min(ml, 15))
+        if lit >= 15:
+            out.extend(lz4_length(lit))
+        out.extend(literals)
+        if offset:
+            out.extend((offset & 0xFF, offset >> 8))
+            if ml >= 15:
+                out.extend(lz4_length(ml))
+
+    while i < n - MATCH_LIMIT:
+        key = bytes(data[i:i + MIN_MATCH])
+        best_len = best_off = 0
+        for j in reversed(heads.get(key, [])[-CHAIN:]):
+            if i - j > MAX_OFFSET:
+                break
+            length = 0
+            limit = n - LAST_LITERALS - i
+            while length < limit and data[j + length] == data[i + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_off = length, i - j
+        if best_len >= MIN_MATCH:
+            emit(data[anchor:i], best_off, best_len)
+            for k in range(i, i + best_len):
+                heads.setdefault(bytes(data[k:k + MIN_MATCH]), []).append(k)
+            i += best_len
+            anchor = i
+        else:
+            heads.setdefault(key, []).append(i)
+            i += 1
+    emit(data[anchor:])
+    return bytes(out)
+
+
+def read_hex(path):
+    """Wozmon hex dump -> [(address, bytes)] of consecutive runs."""
+    segments = []
+    for line in open(path):
+        line = line.split("#")[0].strip()
+        if not line:
+            continue
+        addr, _, data = line.partition(":")
+        addr = int(addr, 16)
+        data = bytes(int(b, 16) for b in data.split())
+        if segments and segments[-1][0] + len(segments[-1][1]) == addr:
+            segments[-1] = (segments[-1][0], segments[-1][1] + data)
+        else:
+            segments.append((addr, data))
+    return segments
+
+
+def read_catalog(root):
+    entries = []
+    for number, line in enumerate(open(os.path.join(root, CATALOG)), 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        fields = line.split()
+        if len(fields) < 5:
+            sys.exit("%s:%d: expected name file load entry title" % (CATALOG, number))
+        name, path, load, entry = fields[:4]
+        rest = fields[4:]
+        boot = rest[0] == "boot"
+        title = " ".join(rest[1:] if boot else rest)
+
+        if path == "-":
+            segments = []
+        elif path.endswith(".hex"):
+            segments = read_hex(os.path.join(root, path))
+        else:
+            data = open(os.path.join(root, path), "rb").read()
+            segments = [(int(load, 16), data)]
+        for addr, data in segments:
+            if addr + len(data) > 0x10000 or len(data) > 0xFFFF:
+                sys.exit("%s:%d: %s doesn't fit in the address space" % (CATALOG, number, path))
+        entries.append((name, title, int(entry, 16), boot, segments))
+    return entries
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def generate(root):
+    entries = read_catalog(root)
+    blob = bytearray()
+    segment_lines = []
+    entry_lines = []
+    unpacked = 0
+
+    for name, title, entry, boot, segments in entries:
+        first = len(segment_lines)
+        for addr, data in segments:
+            block = lz4_compress(data)
+            segment_lines.append("    {0x%04X, %u, %u, %u}," % (addr, len(data), len(blob), len(block)))
+            blob.extend(block)
+            unpacked += len(data)
+        entry_lines.append("    {%s, %s, 0x%04X, %s, %u, %u}," % (
+            c_string(name), c_string(title), entry, "LIBRARY_BOOT" if boot else "0",
+            len(segments), first))
+
+    out = ["#ifndef LIBRARY_BLOB_H",
+           "#define LIBRARY_BLOB_H",
+           "",
+           "// Generated by tools/mklibrary.py from %s; don't edit" % CATALOG,
+           "// %u programs, %u bytes packed into %u" % (len(entries), unpacked, len(blob)),
+           "",
+           '#include "library.h"',
+           "",
+           "static const uint8_t library_blob[] = {"]
+    for i in range(0, len(blob), 12):
+        out.append("  " + ", ".join("0x%02x" % b for b in blob[i:i + 12]) + ",")
+    out += ["};",
+            "",
+            "static const library_segment_t library_segments[] = {"]
+    out += segment_lines
+    out += ["};",
+            "",
+            "static const library_entry_t library_entries[] = {"]
+    out += entry_lines
+    out += ["};",
+            "",
+            "#endif // LIBRARY_BLOB_H",
+            ""]
+    text = "\n".join(out)
+
+    path = os.path.join(root, OUTPUT)
+    if not os.path.exists(path) or open(path).read() != text:
+        with open(path, "w") as f:
+            f.write(text)
+        print("mklibrary: %d programs, %d bytes packed into %d" % (len(entries), unpacked, len(blob)))
+
+
+if "Import" in globals():
+    # Run by PlatformIO as an extra script
+    Import("env")  # noqa: F821
+    generate(env["PROJECT_DIR"])  # noqa: F821
+elif __name__ == "__main__":
+    generate(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
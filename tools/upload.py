@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Load a binary into the Apple-1 emulator over the fast-load protocol.
+
+The frame format is described in include/fastload.h. The file is sent in
+blocks of up to 1 KB, each acknowledged by the device before the next goes
+out; the last one can start the program.
+
+    tools/upload.py prog.bin --addr 0300 --run --port /dev/ttyUSB0
+
+With --native the host build stands in for the board, which is how the
+protocol is tested without hardware:
+
+    platformio run -e native
+    tools/upload.py lib/cellular.bin --addr 0300 --run --type '12\\r15\\r' \\
+        --native .pio/build/native/program
+
+--basic sends Integer BASIC source instead, which the device enters into
+BASIC's program area directly (replacing the current program); --run then
+types RUN:
+
+    tools/upload.py programs/primes.bas --basic --run --port /dev/ttyUSB0
+"""
+
+import argparse
+import codecs
+import os
+import select
+import struct
+import subprocess
+import sys
+import time
+import zlib
+
+SOH = 0x01
+MAGIC = ord("L")
+ACK = 0x06
+NAK = 0x15
+FLAG_RUN = 0x01
+FLAG_BASIC = 0x02
+FLAG_NEW = 0x04
+MAX_BLOCK = 1024
+RETRIES = 3
+
+
+def frame(addr, data, flags=0, entry=0):
+    crc = zlib.crc32(data) & 0xFFFFFFFF
+    return bytes([SOH, MAGIC, flags]) + struct.pack("<HHHI", addr, len(data), entry, crc) + data
+
+
+class SerialLink:
+    def __init__(self, port, baud):
+        import serial  # pyserial
+
+        self.port = serial.Serial()
+        self.port.port = port
+        self.port.baudrate = baud
+        self.port.timeout = 0.05
+        # Opening with DTR/RTS asserted would reset the ESP32
+        self.port.dtr = False
+        self.port.rts = False
+        self.port.open()
+
+    def write(self, data):
+        self.port.write(data)
+        self.port.flush()
+
+    def read(self, timeout):
+        self.port.timeout = timeout
+        return self.port.read(max(1, self.port.in_waiting))
+
+    def finish(self):
+        self.port.close()
+
+
+class NativeLink:
+    def __init__(self, program):
+        self.proc = subprocess.Popen([program, "serial"], stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE)
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+        self.proc.stdin.flush()
+
+    def read(self, timeout):
+        fd = self.proc.stdout.fileno()
+        ready, _, _ = select.select([fd], [], [], timeout)
+        return os.read(fd, 4096) if ready else b""
+
+    def finish(self):
+        # Closing stdin lets the emulator run until it waits for a key again
+        self.proc.stdin.close()
+        while True:
+            data = self.read(1.0)
+            if not data and self.proc.poll() is not None:
+                break
+            sys.stdout.write(data.decode("ascii", "replace"))
+        sys.stdout.flush()
+        return self.proc.wait()
+
+
+def wait_reply(link, timeout=5.0):
+    """Pass device output through until ACK or NAK; None on timeout."""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        for byte in link.read(0.1):
+            if byte in (ACK, NAK):
+                return byte
+            sys.stdout.write(chr(byte))
+        sys.stdout.flush()
+    return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", help="raw binary to load")
+    ap.add_argument("--addr", type=lambda s: int(s, 16), help="load address in hex")
+    ap.add_argument("--basic", action="store_true", help="file is Integer BASIC source")
+    ap.add_argument("--run", nargs="?", const=-1, type=lambda s: int(s, 16),
+                    help="start the program, at ADDR unless another address is given")
+    ap.add_argument("--type", default="",
+                    help="keys to type once loaded (backslash escapes allowed)")
+    ap.add_argument("--block", type=int, default=MAX_BLOCK, help="block size")
+    link_group = ap.add_mutually_exclusive_group(required=True)
+    link_group.add_argument("--port", help="serial port of the board")
+    link_group.add_argument("--native", help="host build of the emulator to drive")
+    ap.add_argument("--baud", type=int, default=57600)
+    args = ap.parse_args()
+
+    with open(args.file, "rb") as f:
+        data = f.read()
+    if not data:
+        sys.exit("nothing to load")
+    if not 0 < args.block <= MAX_BLOCK:
+        sys.exit("block size must be 1..%d" % MAX_BLOCK)
+    if args.basic:
+        args.addr = 0
+        if args.run is not None:
+            args.type = "RUN\\r" + args.type
+            args.run = None
+    elif args.addr is None:
+        sys.exit("--addr is needed for a binary")
+    entry = args.addr if args.run == -1 else args.run
+
+    link = NativeLink(args.native) if args.native else SerialLink(args.port, args.baud)
+
+    start = time.monotonic()
+    for offset in range(0, len(data), args.block):
+        block = data[offset:offset + args.block]
+        last = offset + len(block) == len(data)
+        flags = FLAG_RUN if last and args.run is not None else 0
+        if args.basic:
+            flags = FLAG_BASIC | (FLAG_NEW if offset == 0 else 0)
+        for _ in range(RETRIES):
+            link.write(frame((args.addr + offset) & 0xFFFF, block, flags, entry or 0))
+            reply = wait_reply(link)
+            if reply == ACK:
+                break
+            # Let a half-received frame time out on the device before retrying
+            time.sleep(1.1)
+        else:
+            link.finish()
+            sys.exit("\nblock at $%04X not acknowledged" % (args.addr + offset))
+    elapsed = time.monotonic() - start
+
+    print("\nLoaded %d bytes %s in %.2f s (%.0f bytes/s)"
+          % (len(data), "of BASIC" if args.basic else "at $%04X" % args.addr, elapsed,
+             len(data) / elapsed if elapsed else 0),
+          file=sys.stderr)
+
+    if args.type:
+        link.write(codecs.decode(args.type, "unicode_escape").encode("latin-1"))
+    sys.exit(link.finish() or 0)
+
+
+if __name__ == "__main__":
+    main()